@@ -0,0 +1,83 @@
+#include "harness.h"
+#include "luapp/lua_alloc.hpp"
+
+
+// Allocator presets: each iteration creates a fresh state, runs a script producing
+// strings, tables and closures, then closes the state. Baseline is the default realloc-based allocator.
+
+static const char* const workload =
+	"local t = {} "
+	"for i = 1, 200 do "
+	"  local s = 'key' .. i "
+	"  t[s] = {i, s, function() return s end} "
+	"end "
+	"for k in next, t do t[k] = nil end";
+
+
+
+static void runWorkload(lua_State* L)
+{
+	luaL_loadstring(L, workload);
+	lua_call(L, 0, 0);
+	lua_close(L);
+}
+
+
+
+LUAPP_BENCH(allocPool, raw)
+{
+	for(size_t i = 0; i < iterations; ++i)
+		runWorkload(lua_newstate(lua::alloc::standard, nullptr));
+}
+
+LUAPP_BENCH(allocPool, luapp)
+{
+	lua::alloc::Pool pool;
+	for(size_t i = 0; i < iterations; ++i)
+		runWorkload(lua_newstate(lua::alloc::Pool::allocate, &pool));
+}
+
+
+
+LUAPP_BENCH(allocArena, raw)
+{
+	bench_allocPool_raw(context, iterations);
+}
+
+LUAPP_BENCH(allocArena, luapp)
+{
+	lua::alloc::Arena arena;
+	for(size_t i = 0; i < iterations; ++i) {
+		runWorkload(lua_newstate(lua::alloc::Arena::allocate, &arena));
+		arena.reset();
+	}
+}
+
+
+
+LUAPP_BENCH(allocLimited, raw)
+{
+	bench_allocPool_raw(context, iterations);
+}
+
+LUAPP_BENCH(allocLimited, luapp)
+{
+	lua::alloc::Limited limited(64 * 1024 * 1024);
+	for(size_t i = 0; i < iterations; ++i)
+		runWorkload(lua_newstate(lua::alloc::Limited::allocate, &limited));
+}
+
+
+
+LUAPP_BENCH(allocTracking, raw)
+{
+	bench_allocPool_raw(context, iterations);
+}
+
+LUAPP_BENCH(allocTracking, luapp)
+{
+	lua::alloc::Tracking tracking;
+	for(size_t i = 0; i < iterations; ++i)
+		runWorkload(lua_newstate(lua::alloc::Tracking::allocate, &tracking));
+	bench::keep(static_cast<long long>(tracking.stats().allocations));
+}
@@ -0,0 +1,46 @@
+#include "harness.h"
+#if defined(__cpp_impl_coroutine) && (LUAPP_API_VERSION >= 52)
+#include "luapp/lua_async.hpp"
+
+using lua::Context;
+using lua::Coroutine;
+using lua::Retval;
+using lua::async::Scheduler;
+using lua::async::Task;
+
+
+// Asynchronous call round trip: Lua calls a function that suspends its coroutine and is resumed by the driver.
+
+static const char* const callLoop = "local f, n = ... for i = 1, n do f(i) end";
+
+
+
+static Retval lYield(Context& c)
+{
+	return c.yield();
+}
+
+LUAPP_BENCH(asyncCall, raw)
+{
+	Coroutine co(context.chunk(callLoop), context);
+	co.resume(lua::mkcf<lYield>, static_cast<double>(iterations));
+	while(co.isResumable())
+		co.resume();
+}
+
+
+
+static Task<int> deferred(Scheduler& sched, int x)
+{
+	co_await sched.schedule();
+	co_return x;
+}
+
+LUAPP_BENCH(asyncCall, luapp)
+{
+	Scheduler sched(context);
+	sched.spawn(context.chunk(callLoop), context.wrap([&sched](int x){ return deferred(sched, x); }), static_cast<double>(iterations));
+	sched.run();
+}
+
+#endif	// C++20 coroutines, V52+
@@ -0,0 +1,249 @@
+#include "harness.h"
+
+using lua::Context;
+using lua::Retval;
+using lua::Value;
+using lua::Valset;
+using lua::mkcf;
+
+
+// Valset construction and round trips through function wrappers (Lua call into C++ and back).
+
+#if(LUAPP_API_VERSION >= 53)
+#define BENCH_PUSH_INT lua_pushinteger
+#define BENCH_TO_INT lua_tointeger
+#else
+#define BENCH_PUSH_INT lua_pushnumber
+#define BENCH_TO_INT lua_tonumber
+#endif
+
+
+LUAPP_BENCH(valsetConstruct, raw)
+{
+	for(size_t i = 0; i < iterations; ++i) {
+		BENCH_PUSH_INT(context, 1);
+		lua_pushnumber(context, 2.0);
+		lua_pushstring(context, "three");
+		lua_pop(context, 3);
+	}
+}
+
+LUAPP_BENCH(valsetConstruct, luapp)
+{
+	for(size_t i = 0; i < iterations; ++i) {
+		Valset vs(context);
+		vs.push_back(1, 2.0, "three");
+	}
+}
+
+
+
+static int rawTriple(lua_State* L)
+{
+	BENCH_PUSH_INT(L, 1);
+	lua_pushnumber(L, 2.0);
+	lua_pushstring(L, "three");
+	return 3;
+}
+
+LUAPP_BENCH(valsetFromCall, raw)
+{
+	lua_pushcfunction(context, rawTriple);
+	const int fn = lua_gettop(context);
+	for(size_t i = 0; i < iterations; ++i) {
+		lua_pushvalue(context, fn);
+		lua_call(context, 0, LUA_MULTRET);
+		lua_settop(context, fn);
+	}
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(valsetFromCall, luapp)
+{
+	Value fn(rawTriple, context);
+	for(size_t i = 0; i < iterations; ++i)
+		Valset vs = fn();
+}
+
+
+
+static int rawIncrement(lua_State* L)
+{
+	BENCH_PUSH_INT(L, BENCH_TO_INT(L, 1) + 1);
+	return 1;
+}
+
+static Retval lppIncrement(Context& c)
+{
+	return c.ret(c.args[0].cast<int>() + 1);
+}
+
+static int nativeIncrement(int x)
+{
+	return x + 1;
+}
+
+LUAPP_BENCH(callCFunction, raw)
+{
+	lua_pushcfunction(context, rawIncrement);
+	const int fn = lua_gettop(context);
+	for(size_t i = 0; i < iterations; ++i) {
+		lua_pushvalue(context, fn);
+		BENCH_PUSH_INT(context, static_cast<int>(i));
+		lua_call(context, 1, 1);
+		bench::keep(static_cast<int>(BENCH_TO_INT(context, -1)));
+		lua_pop(context, 1);
+	}
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(callCFunction, luapp)
+{
+	Value fn(rawIncrement, context);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(fn(static_cast<int>(i)).cast<int>());
+}
+
+
+
+// Same raw baseline as above, but the callee is an LFunction behind mkcf wrapper
+LUAPP_BENCH(callMkcf, raw)
+{
+	bench_callCFunction_raw(context, iterations);
+}
+
+LUAPP_BENCH(callMkcf, luapp)
+{
+	Value fn(mkcf<lppIncrement>, context);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(fn(static_cast<int>(i)).cast<int>());
+}
+
+
+
+LUAPP_BENCH(callClosure, raw)
+{
+	bench_callCFunction_raw(context, iterations);
+}
+
+LUAPP_BENCH(callClosure, luapp)
+{
+	Value fn = context.closure(lppIncrement);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(fn(static_cast<int>(i)).cast<int>());
+}
+
+
+
+LUAPP_BENCH(callWrapped, raw)
+{
+	bench_callCFunction_raw(context, iterations);
+}
+
+LUAPP_BENCH(callWrapped, luapp)
+{
+	Value fn = context.wrap(nativeIncrement);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(fn(static_cast<int>(i)).cast<int>());
+}
+
+
+
+LUAPP_BENCH(callFastWrapped, raw)
+{
+	bench_callCFunction_raw(context, iterations);
+}
+
+LUAPP_BENCH(callFastWrapped, luapp)
+{
+	Value fn = context.fastwrap(nativeIncrement);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(fn(static_cast<int>(i)).cast<int>());
+}
+
+
+
+LUAPP_BENCH(callStatic, raw)
+{
+	bench_callCFunction_raw(context, iterations);
+}
+
+LUAPP_BENCH(callStatic, luapp)
+{
+	Value fn(lua::wrapcf<decltype(&nativeIncrement), &nativeIncrement>, context);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(fn(static_cast<int>(i)).cast<int>());
+}
+
+
+
+// Calls made from Lua code, so only the C++ side of the boundary is measured
+static const char* const luaLoop = "local f, n = ... for i = 1, n do f(i) end";
+
+LUAPP_BENCH(luaCallsMkcf, raw)
+{
+	luaL_loadstring(context, luaLoop);
+	lua_pushcfunction(context, rawIncrement);
+	lua_pushnumber(context, static_cast<double>(iterations));
+	lua_call(context, 2, 0);
+}
+
+LUAPP_BENCH(luaCallsMkcf, luapp)
+{
+	Value loop = context.chunk(luaLoop);
+	loop(mkcf<lppIncrement>, static_cast<double>(iterations));
+}
+
+
+
+LUAPP_BENCH(luaCallsWrapped, raw)
+{
+	bench_luaCallsMkcf_raw(context, iterations);
+}
+
+LUAPP_BENCH(luaCallsWrapped, luapp)
+{
+	Value loop = context.chunk(luaLoop);
+	loop(context.wrap(nativeIncrement), static_cast<double>(iterations));
+}
+
+
+
+LUAPP_BENCH(callFunctor, raw)
+{
+	bench_callCFunction_raw(context, iterations);
+}
+
+LUAPP_BENCH(callFunctor, luapp)
+{
+	const int step = 1;
+	Value fn = context.wrap([step](int x) {return x + step;});
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(fn(static_cast<int>(i)).cast<int>());
+}
+
+
+
+LUAPP_BENCH(luaCallsStatic, raw)
+{
+	bench_luaCallsMkcf_raw(context, iterations);
+}
+
+LUAPP_BENCH(luaCallsStatic, luapp)
+{
+	Value loop = context.chunk(luaLoop);
+	loop(lua::wrapcf<decltype(&nativeIncrement), &nativeIncrement>, static_cast<double>(iterations));
+}
+
+
+
+LUAPP_BENCH(luaCallsFastStatic, raw)
+{
+	bench_luaCallsMkcf_raw(context, iterations);
+}
+
+LUAPP_BENCH(luaCallsFastStatic, luapp)
+{
+	Value loop = context.chunk(luaLoop);
+	loop(lua::fastwrapcf<decltype(&nativeIncrement), &nativeIncrement>, static_cast<double>(iterations));
+}
@@ -0,0 +1,100 @@
+#include "harness.h"
+#include <cstdio>
+
+using lua::Value;
+
+
+// Chunk compilation: plain compilation is the baseline for cached chunks.
+
+static const char* const handlerText =
+	"local request = ... "
+	"local total = 0 "
+	"for i = 1, #request do total = total + request[i] * 2 end "
+	"if total > 100 then return 'large', total else return 'small', total end";
+
+
+
+LUAPP_BENCH(chunk, raw)
+{
+	for(size_t i = 0; i < iterations; ++i) {
+		luaL_loadstring(context, handlerText);
+		lua_pop(context, 1);
+	}
+}
+
+LUAPP_BENCH(chunk, luapp)
+{
+	for(size_t i = 0; i < iterations; ++i)
+		Value c = context.chunk(handlerText);
+}
+
+
+
+LUAPP_BENCH(cachedChunk, raw)
+{
+	bench_chunk_raw(context, iterations);
+}
+
+LUAPP_BENCH(cachedChunk, luapp)
+{
+	for(size_t i = 0; i < iterations; ++i)
+		Value c = context.cachedChunk(handlerText);
+}
+
+
+
+// Generated data script (about 130 KB), written once into the current directory and removed at exit
+static const char* dataScript()
+{
+	static const struct DataFile {
+		const char* const name = "bench_data.lua";
+
+		DataFile()
+		{
+			std::FILE* f = std::fopen(name, "w");
+			std::fputs("return {\n", f);
+			for(int i = 0; i < 2000; ++i)
+				std::fprintf(f, "\t{id = %d, name = \"item%d\", weight = %d.5, tags = {\"a\", \"b\"}},\n", i, i, i % 97);
+			std::fputs("}\n", f);
+			std::fclose(f);
+		}
+
+		~DataFile()
+		{
+			std::remove(name);
+		}
+	} file;
+	return file.name;
+}
+
+
+
+LUAPP_BENCH(loadFile, raw)
+{
+	const char* const fileName = dataScript();
+	for(size_t i = 0; i < iterations; ++i) {
+		luaL_loadfile(context, fileName);
+		lua_pop(context, 1);
+	}
+}
+
+LUAPP_BENCH(loadFile, luapp)
+{
+	const char* const fileName = dataScript();
+	for(size_t i = 0; i < iterations; ++i)
+		Value c = context.load(fileName);
+}
+
+
+
+LUAPP_BENCH(loadMapped, raw)
+{
+	bench_loadFile_raw(context, iterations);
+}
+
+LUAPP_BENCH(loadMapped, luapp)
+{
+	const char* const fileName = dataScript();
+	for(size_t i = 0; i < iterations; ++i)
+		Value c = context.loadMapped(fileName);
+}
@@ -0,0 +1,225 @@
+#include "harness.h"
+#include <string>
+
+using lua::Value;
+
+
+// Valref::cast, to and is compared to corresponding Lua API checks and conversions.
+
+struct BenchVector{double x, y, z;};
+LUAPP_USERDATA(BenchVector, "Bench.Vector")
+
+
+LUAPP_BENCH(castInt, raw)
+{
+	lua_pushnumber(context, 42);
+	for(size_t i = 0; i < iterations; ++i) {
+#if(LUAPP_API_VERSION >= 52)
+		int isnum = 0;
+		const lua_Number n = lua_tonumberx(context, -1, &isnum);
+#else
+		const int isnum = lua_isnumber(context, -1);
+		const lua_Number n = lua_tonumber(context, -1);
+#endif
+		if(isnum)
+			bench::keep(static_cast<int>(n));
+	}
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(castInt, luapp)
+{
+	Value v(42, context);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(v.cast<int>());
+}
+
+
+
+LUAPP_BENCH(toInt, raw)
+{
+	lua_pushnumber(context, 42);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(static_cast<int>(lua_tonumber(context, -1)));
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(toInt, luapp)
+{
+	Value v(42, context);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(v.to<int>());
+}
+
+
+
+LUAPP_BENCH(isInt, raw)
+{
+	lua_pushnumber(context, 42);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(lua_isnumber(context, -1) != 0);
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(isInt, luapp)
+{
+	Value v(42, context);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(v.is<int>());
+}
+
+
+
+LUAPP_BENCH(castDouble, raw)
+{
+	lua_pushnumber(context, 3.14);
+	for(size_t i = 0; i < iterations; ++i) {
+#if(LUAPP_API_VERSION >= 52)
+		int isnum = 0;
+		const lua_Number n = lua_tonumberx(context, -1, &isnum);
+#else
+		const int isnum = lua_isnumber(context, -1);
+		const lua_Number n = lua_tonumber(context, -1);
+#endif
+		if(isnum)
+			bench::keep(n);
+	}
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(castDouble, luapp)
+{
+	Value v(3.14, context);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(v.cast<double>());
+}
+
+
+
+LUAPP_BENCH(castBool, raw)
+{
+	lua_pushboolean(context, 1);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(lua_toboolean(context, -1) != 0);
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(castBool, luapp)
+{
+	Value v(true, context);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(v.cast<bool>());
+}
+
+
+
+LUAPP_BENCH(castCString, raw)
+{
+	lua_pushstring(context, "benchmark string");
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(static_cast<const void*>(lua_tostring(context, -1)));
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(castCString, luapp)
+{
+	Value v("benchmark string", context);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(static_cast<const void*>(v.cast<const char*>()));
+}
+
+
+
+LUAPP_BENCH(castStdString, raw)
+{
+	const std::string src(1024, 'x');
+	lua_pushlstring(context, src.data(), src.size());
+	for(size_t i = 0; i < iterations; ++i) {
+		size_t len = 0;
+		const char* str = lua_tolstring(context, -1, &len);
+		bench::keep(std::string(str, len));
+	}
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(castStdString, luapp)
+{
+	const std::string src(1024, 'x');
+	Value v(src, context);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(v.cast<std::string>());
+}
+
+
+
+LUAPP_BENCH(isString, raw)
+{
+	lua_pushstring(context, "benchmark string");
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(lua_isstring(context, -1) != 0);
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(isString, luapp)
+{
+	Value v("benchmark string", context);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(v.is<std::string>());
+}
+
+
+
+LUAPP_BENCH(isUserData, raw)
+{
+	luaL_newmetatable(context, "Bench.Vector");
+	lua_pop(context, 1);
+	new (lua_newuserdata(context, sizeof(BenchVector))) BenchVector{1, 2, 3};
+	luaL_getmetatable(context, "Bench.Vector");
+	lua_setmetatable(context, -2);
+	for(size_t i = 0; i < iterations; ++i) {
+		bool rv = false;
+		if(lua_getmetatable(context, -1)) {
+			luaL_getmetatable(context, "Bench.Vector");
+			rv = lua_rawequal(context, -1, -2) != 0;
+			lua_pop(context, 2);
+		}
+		bench::keep(rv);
+	}
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(isUserData, luapp)
+{
+	context.mt<BenchVector>() = lua::Table::records(context);
+	Value v(BenchVector{1, 2, 3}, context);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(v.is<BenchVector>());
+}
+
+
+
+LUAPP_BENCH(castUserData, raw)
+{
+	luaL_newmetatable(context, "Bench.Vector");
+	lua_pop(context, 1);
+	new (lua_newuserdata(context, sizeof(BenchVector))) BenchVector{1, 2, 3};
+	luaL_getmetatable(context, "Bench.Vector");
+	lua_setmetatable(context, -2);
+	for(size_t i = 0; i < iterations; ++i) {
+		if(lua_getmetatable(context, -1)) {
+			luaL_getmetatable(context, "Bench.Vector");
+			if(lua_rawequal(context, -1, -2))
+				bench::keep(static_cast<BenchVector*>(lua_touserdata(context, -3))->y);
+			lua_pop(context, 2);
+		}
+	}
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(castUserData, luapp)
+{
+	context.mt<BenchVector>() = lua::Table::records(context);
+	Value v(BenchVector{1, 2, 3}, context);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(v.cast<BenchVector>().y);
+}
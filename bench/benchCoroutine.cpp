@@ -0,0 +1,35 @@
+#include "harness.h"
+
+using lua::Coroutine;
+
+
+// Coroutine round trip: resume with one value, the coroutine yields it back.
+
+static const char* const echoLoop = "local x = ... while true do x = coroutine.yield(x) end";
+
+
+
+LUAPP_BENCH(coroutineResume, raw)
+{
+	lua_State* thread = lua_newthread(context);
+	luaL_loadstring(thread, echoLoop);
+	for(size_t i = 0; i < iterations; ++i) {
+		lua_pushnumber(thread, static_cast<double>(i));
+#if(LUAPP_API_VERSION >= 52)
+		lua_resume(thread, context, 1);
+#else
+		lua_resume(thread, 1);
+#endif
+		lua_xmove(thread, context, 1);
+		bench::keep(static_cast<double>(lua_tonumber(context, -1)));
+		lua_pop(context, 1);
+	}
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(coroutineResume, luapp)
+{
+	Coroutine co(context.chunk(echoLoop), context);
+	for(size_t i = 0; i < iterations; ++i)
+		bench::keep(co.resume(static_cast<double>(i)).cast<double>());
+}
@@ -0,0 +1,249 @@
+#include "harness.h"
+#include <string>
+
+using lua::Context;
+using lua::Retval;
+using lua::Value;
+
+
+// Context::push is exercised through Value construction (push + pop), raw versions do the same with Lua API.
+
+struct BenchPoint{double x, y;};
+LUAPP_USERDATA(BenchPoint, "Bench.Point")
+
+
+LUAPP_BENCH(pushNil, raw)
+{
+	for(size_t i = 0; i < iterations; ++i) {
+		lua_pushnil(context);
+		lua_pop(context, 1);
+	}
+}
+
+LUAPP_BENCH(pushNil, luapp)
+{
+	for(size_t i = 0; i < iterations; ++i)
+		Value v(lua::nil, context);
+}
+
+
+
+LUAPP_BENCH(pushBool, raw)
+{
+	for(size_t i = 0; i < iterations; ++i) {
+		lua_pushboolean(context, i & 1);
+		lua_pop(context, 1);
+	}
+}
+
+LUAPP_BENCH(pushBool, luapp)
+{
+	for(size_t i = 0; i < iterations; ++i)
+		Value v((i & 1) != 0, context);
+}
+
+
+
+LUAPP_BENCH(pushInt, raw)
+{
+	for(size_t i = 0; i < iterations; ++i) {
+#if(LUAPP_API_VERSION >= 53)
+		lua_pushinteger(context, static_cast<int>(i));
+#else
+		lua_pushnumber(context, static_cast<int>(i));
+#endif
+		lua_pop(context, 1);
+	}
+}
+
+LUAPP_BENCH(pushInt, luapp)
+{
+	for(size_t i = 0; i < iterations; ++i)
+		Value v(static_cast<int>(i), context);
+}
+
+
+
+LUAPP_BENCH(pushLongLong, raw)
+{
+	for(size_t i = 0; i < iterations; ++i) {
+#if(LUAPP_API_VERSION >= 53)
+		lua_pushinteger(context, static_cast<long long>(i));
+#else
+		lua_pushnumber(context, static_cast<long long>(i));
+#endif
+		lua_pop(context, 1);
+	}
+}
+
+LUAPP_BENCH(pushLongLong, luapp)
+{
+	for(size_t i = 0; i < iterations; ++i)
+		Value v(static_cast<long long>(i), context);
+}
+
+
+
+LUAPP_BENCH(pushDouble, raw)
+{
+	for(size_t i = 0; i < iterations; ++i) {
+		lua_pushnumber(context, i * 0.5);
+		lua_pop(context, 1);
+	}
+}
+
+LUAPP_BENCH(pushDouble, luapp)
+{
+	for(size_t i = 0; i < iterations; ++i)
+		Value v(i * 0.5, context);
+}
+
+
+
+LUAPP_BENCH(pushCString, raw)
+{
+	for(size_t i = 0; i < iterations; ++i) {
+		lua_pushstring(context, "benchmark string");
+		lua_pop(context, 1);
+	}
+}
+
+LUAPP_BENCH(pushCString, luapp)
+{
+	for(size_t i = 0; i < iterations; ++i)
+		Value v("benchmark string", context);
+}
+
+
+
+LUAPP_BENCH(pushStdString, raw)
+{
+	const std::string str(1024, 'x');
+	for(size_t i = 0; i < iterations; ++i) {
+		lua_pushlstring(context, str.data(), str.size());
+		lua_pop(context, 1);
+	}
+}
+
+LUAPP_BENCH(pushStdString, luapp)
+{
+	const std::string str(1024, 'x');
+	for(size_t i = 0; i < iterations; ++i)
+		Value v(str, context);
+}
+
+
+
+static int rawFunction(lua_State*)
+{
+	return 0;
+}
+
+LUAPP_BENCH(pushCFunction, raw)
+{
+	for(size_t i = 0; i < iterations; ++i) {
+		lua_pushcfunction(context, rawFunction);
+		lua_pop(context, 1);
+	}
+}
+
+LUAPP_BENCH(pushCFunction, luapp)
+{
+	for(size_t i = 0; i < iterations; ++i)
+		Value v(rawFunction, context);
+}
+
+
+
+static Retval emptyFunction(Context& c)
+{
+	return c.ret();
+}
+
+LUAPP_BENCH(pushLFunction, raw)
+{
+	for(size_t i = 0; i < iterations; ++i) {
+		lua_pushlightuserdata(context, reinterpret_cast<void*>(emptyFunction));
+		lua_pushcclosure(context, rawFunction, 1);
+		lua_pop(context, 1);
+	}
+}
+
+LUAPP_BENCH(pushLFunction, luapp)
+{
+	for(size_t i = 0; i < iterations; ++i)
+		Value v(emptyFunction, context);
+}
+
+
+
+LUAPP_BENCH(pushLightUserData, raw)
+{
+	for(size_t i = 0; i < iterations; ++i) {
+		lua_pushlightuserdata(context, &context);
+		lua_pop(context, 1);
+	}
+}
+
+LUAPP_BENCH(pushLightUserData, luapp)
+{
+	for(size_t i = 0; i < iterations; ++i)
+		Value v(static_cast<lua::LightUserData>(&context), context);
+}
+
+
+
+LUAPP_BENCH(pushValref, raw)
+{
+	lua_pushnumber(context, 1.0);
+	const int idx = lua_gettop(context);
+	for(size_t i = 0; i < iterations; ++i) {
+		lua_pushvalue(context, idx);
+		lua_pop(context, 1);
+	}
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(pushValref, luapp)
+{
+	Value src(1.0, context);
+	for(size_t i = 0; i < iterations; ++i)
+		Value v(src);
+}
+
+
+
+LUAPP_BENCH(pushUserData, raw)
+{
+	luaL_newmetatable(context, "Bench.Point");
+	lua_pop(context, 1);
+	const BenchPoint pt{1.0, 2.0};
+	for(size_t i = 0; i < iterations; ++i) {
+		new (lua_newuserdata(context, sizeof(BenchPoint))) BenchPoint(pt);
+		luaL_getmetatable(context, "Bench.Point");
+		lua_setmetatable(context, -2);
+		lua_pop(context, 1);
+	}
+}
+
+LUAPP_BENCH(pushUserData, luapp)
+{
+	context.mt<BenchPoint>() = lua::Table::records(context);
+	const BenchPoint pt{1.0, 2.0};
+	for(size_t i = 0; i < iterations; ++i)
+		Value v(pt, context);
+}
+
+
+
+LUAPP_BENCH(emplaceUserData, raw)
+{
+	bench_pushUserData_raw(context, iterations);
+}
+
+LUAPP_BENCH(emplaceUserData, luapp)
+{
+	context.mt<BenchPoint>() = lua::Table::records(context);
+	for(size_t i = 0; i < iterations; ++i)
+		Value v(context.emplace<BenchPoint>(1.0, 2.0));
+}
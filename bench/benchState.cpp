@@ -0,0 +1,32 @@
+#include "harness.h"
+
+
+// State creation cost: all standard libraries versus a minimal sandbox-style selection.
+
+LUAPP_BENCH(stateAllLibraries, raw)
+{
+	for(size_t i = 0; i < iterations; ++i) {
+		lua_State* L = luaL_newstate();
+		luaL_openlibs(L);
+		lua_close(L);
+	}
+}
+
+LUAPP_BENCH(stateAllLibraries, luapp)
+{
+	for(size_t i = 0; i < iterations; ++i)
+		lua::State s;
+}
+
+
+
+LUAPP_BENCH(stateSelectedLibraries, raw)
+{
+	bench_stateAllLibraries_raw(context, iterations);
+}
+
+LUAPP_BENCH(stateSelectedLibraries, luapp)
+{
+	for(size_t i = 0; i < iterations; ++i)
+		lua::State s(lua::lib::base | lua::lib::string | lua::lib::table | lua::lib::math);
+}
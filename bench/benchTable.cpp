@@ -0,0 +1,168 @@
+#include "harness.h"
+#include <string>
+#include <vector>
+
+using lua::Table;
+
+
+// Filling an array table from a native vector, one element per iteration.
+
+static std::vector<double> numbers(size_t size)
+{
+	std::vector<double> result(size);
+	for(size_t i = 0; i < size; ++i)
+		result[i] = static_cast<double>(i);
+	return result;
+}
+
+static std::vector<std::string> strings(size_t size)
+{
+	std::vector<std::string> result(size);
+	for(size_t i = 0; i < size; ++i)
+		result[i] = std::to_string(i);
+	return result;
+}
+
+
+
+LUAPP_BENCH(tableFillNumbers, raw)
+{
+	const std::vector<double> src = numbers(iterations);
+	lua_createtable(context, static_cast<int>(src.size()), 0);
+	for(size_t i = 0; i < src.size(); ++i) {
+		lua_pushnumber(context, src[i]);
+		lua_rawseti(context, -2, static_cast<int>(i + 1));
+	}
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(tableFillNumbers, luapp)
+{
+	const std::vector<double> src = numbers(iterations);
+	Table t = Table::fromRange(context, src);
+}
+
+LUAPP_BENCH(tableFillNumbers, indexer)
+{
+	const std::vector<double> src = numbers(iterations);
+	Table t(context, src.size());
+	for(size_t i = 0; i < src.size(); ++i)
+		t.raw[static_cast<int>(i + 1)] = src[i];
+}
+
+
+
+LUAPP_BENCH(tableFillStrings, raw)
+{
+	const std::vector<std::string> src = strings(iterations);
+	lua_createtable(context, static_cast<int>(src.size()), 0);
+	for(size_t i = 0; i < src.size(); ++i) {
+		lua_pushlstring(context, src[i].data(), src[i].size());
+		lua_rawseti(context, -2, static_cast<int>(i + 1));
+	}
+	lua_pop(context, 1);
+}
+
+LUAPP_BENCH(tableFillStrings, luapp)
+{
+	const std::vector<std::string> src = strings(iterations);
+	Table t = Table::fromRange(context, src);
+}
+
+
+
+// Reading an array table into a native vector, one element per iteration.
+
+static void makeArray(lua::Context& context, size_t size)
+{
+	lua_createtable(context, static_cast<int>(size), 0);
+	for(size_t i = 0; i < size; ++i) {
+		lua_pushnumber(context, static_cast<double>(i));
+		lua_rawseti(context, -2, static_cast<int>(i + 1));
+	}
+	lua_setglobal(context, "benchArray");
+}
+
+LUAPP_BENCH(tableExtractNumbers, raw)
+{
+	makeArray(context, iterations);
+	lua_getglobal(context, "benchArray");
+	std::vector<int> dst;
+#if(LUAPP_API_VERSION >= 52)
+	const size_t len = lua_rawlen(context, -1);
+#else
+	const size_t len = lua_objlen(context, -1);
+#endif
+	dst.reserve(len);
+	for(size_t i = 1; i <= len; ++i) {
+		lua_rawgeti(context, -1, static_cast<int>(i));
+		dst.push_back(static_cast<int>(lua_tonumber(context, -1)));
+		lua_pop(context, 1);
+	}
+	lua_pop(context, 1);
+	bench::keep(static_cast<int>(dst.size()));
+}
+
+LUAPP_BENCH(tableExtractNumbers, luapp)
+{
+	makeArray(context, iterations);
+	Table t = context.global["benchArray"];
+	bench::keep(static_cast<int>(t.toVector<int>().size()));
+}
+
+LUAPP_BENCH(tableExtractNumbers, indexer)
+{
+	makeArray(context, iterations);
+	Table t = context.global["benchArray"];
+	std::vector<int> dst;
+	for(size_t i = 1; i <= iterations; ++i)
+		dst.push_back(t.raw[static_cast<int>(i)].cast<int>());
+	bench::keep(static_cast<int>(dst.size()));
+}
+
+
+
+// Summing array table elements, one element per iteration.
+
+LUAPP_BENCH(tableTraverse, raw)
+{
+	makeArray(context, iterations);
+	lua_getglobal(context, "benchArray");
+	double sum = 0;
+	lua_pushnil(context);
+	while(lua_next(context, -2)) {
+		sum += lua_tonumber(context, -1);
+		lua_pop(context, 1);
+	}
+	lua_pop(context, 1);
+	bench::keep(sum);
+}
+
+LUAPP_BENCH(tableTraverse, iterate)
+{
+	makeArray(context, iterations);
+	Table t = context.global["benchArray"];
+	double sum = 0;
+	t.iterate([&sum](lua::Valref, lua::Valref v) { sum += v.cast<double>(); });
+	bench::keep(sum);
+}
+
+LUAPP_BENCH(tableTraverse, pairs)
+{
+	makeArray(context, iterations);
+	Table t = context.global["benchArray"];
+	double sum = 0;
+	for(auto e : t.pairs())
+		sum += e.value.cast<double>();
+	bench::keep(sum);
+}
+
+LUAPP_BENCH(tableTraverse, ipairs)
+{
+	makeArray(context, iterations);
+	Table t = context.global["benchArray"];
+	double sum = 0;
+	for(auto e : t.ipairs())
+		sum += e.value.cast<double>();
+	bench::keep(sum);
+}
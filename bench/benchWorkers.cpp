@@ -0,0 +1,40 @@
+#include "harness.h"
+#include "luapp/lua_workers.hpp"
+#include <future>
+#include <vector>
+
+
+// Worker runtime: a batch of calls to a Lua function doing some arithmetic.
+// Baseline runs the same calls one by one on the benchmark's own state, so the ratio shows the gain from extra cores
+// (or the dispatch overhead, when the work per call is too small).
+
+static const char* const workerFunction =
+	"function work(n) local x = 0 for i = 1, n do x = x + i % 7 end return x end";
+
+static const int workPerCall = 2000;
+
+
+
+LUAPP_BENCH(workersBatch, raw)
+{
+	luaL_loadstring(context, workerFunction);
+	lua_call(context, 0, 0);
+	for(size_t i = 0; i < iterations; ++i) {
+		lua_getglobal(context, "work");
+		lua_pushnumber(context, workPerCall);
+		lua_call(context, 1, 1);
+		bench::keep(static_cast<double>(lua_tonumber(context, -1)));
+		lua_pop(context, 1);
+	}
+}
+
+LUAPP_BENCH(workersBatch, luapp)
+{
+	static lua::Workers workers(0, [](lua::State& s){ s.runString(workerFunction); });
+	std::vector<std::future<lua::Workers::Values>> replies;
+	replies.reserve(iterations);
+	for(size_t i = 0; i < iterations; ++i)
+		replies.push_back(workers.call("work", workPerCall));
+	for(auto& r : replies)
+		bench::keep(r.get()[0].cast<double>());
+}
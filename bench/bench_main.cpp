@@ -0,0 +1,111 @@
+#include "harness.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+// Usage: bench [filter] [--min-time=milliseconds]
+// Only operations whose name contains the filter substring are run.
+
+namespace bench {
+
+	volatile size_t sink = 0;
+
+	namespace {
+
+		struct Case {
+			std::string operation;
+			std::string variant;
+			Body body;
+		};
+
+		std::vector<Case>& registry()
+		{
+			static std::vector<Case> cases;
+			return cases;
+		}
+
+		using Clock = std::chrono::steady_clock;
+
+		double runOnce(Body body, size_t iterations)
+		{
+			lua::State state;
+			lua::Context context(state.getRawState(), lua::Context::initializeExplicitly);
+			const auto start = Clock::now();
+			body(context, iterations);
+			const auto stop = Clock::now();
+			return std::chrono::duration<double, std::nano>(stop - start).count();
+		}
+
+		//! Nanoseconds per iteration, best of several runs lasting at least minTime each.
+		double measure(Body body, double minTime)
+		{
+			size_t iterations = 1000;
+			double elapsed = runOnce(body, iterations);
+			while(elapsed < minTime) {
+				const double scale = elapsed > 0 ? std::min(10.0, 1.2 * minTime / elapsed) : 10.0;
+				iterations = static_cast<size_t>(iterations * std::max(2.0, scale));
+				elapsed = runOnce(body, iterations);
+			}
+			double best = elapsed;
+			for(int i = 0; i < 4; ++i)
+				best = std::min(best, runOnce(body, iterations));
+			return best / iterations;
+		}
+	}
+
+
+	Registrar::Registrar(const char* operation, const char* variant, Body body)
+	{
+		registry().push_back(Case{operation, variant, body});
+	}
+}
+
+
+
+int main(int argc, char** argv)
+{
+	const char* filter = "";
+	double minTime = 50e6;	// ns
+	for(int i = 1; i < argc; ++i) {
+		if(std::strncmp(argv[i], "--min-time=", 11) == 0)
+			minTime = std::atof(argv[i] + 11) * 1e6;
+		else
+			filter = argv[i];
+	}
+
+	// operation -> variant -> ns/op, ordered by first registration
+	std::vector<std::string> order;
+	std::map<std::string, std::map<std::string, double>> results;
+	for(const auto& c: bench::registry()) {
+		if(c.operation.find(filter) == std::string::npos)
+			continue;
+		if(results.find(c.operation) == results.end())
+			order.push_back(c.operation);
+		results[c.operation][c.variant] = bench::measure(c.body, minTime);
+	}
+
+	std::printf("%-28s %12s %12s %12s\n", "operation", "raw, ns", "luapp, ns", "overhead, ns");
+	for(const auto& op: order) {
+		const auto& r = results[op];
+		const auto raw = r.find("raw"), luapp = r.find("luapp");
+		std::printf("%-28s ", op.c_str());
+		if(raw != r.end())
+			std::printf("%12.2f ", raw->second);
+		else
+			std::printf("%12s ", "-");
+		if(luapp != r.end())
+			std::printf("%12.2f ", luapp->second);
+		else
+			std::printf("%12s ", "-");
+		if(raw != r.end() && luapp != r.end())
+			std::printf("%+12.2f\n", luapp->second - raw->second);
+		else
+			std::printf("%12s\n", "-");
+	}
+	return 0;
+}
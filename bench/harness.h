@@ -0,0 +1,50 @@
+#ifndef HARNESS_H_INCLUDED
+#define HARNESS_H_INCLUDED
+
+#include "luapp/lua.hpp"
+#include "luapp/luainc.h"
+#include <cstddef>
+#include <string>
+
+
+namespace bench {
+
+	//! Benchmark body: performs measured operation "iterations" times.
+	//! Stack must be left intact after the body returns.
+	using Body = void (*)(lua::Context& context, size_t iterations);
+
+	//! Static registration of benchmark cases.
+	//! Cases sharing the operation name are reported side by side, "raw" variant being the baseline.
+	struct Registrar {
+		Registrar(const char* operation, const char* variant, Body body);
+	};
+
+	//! Sink that keeps computed values from being optimized away.
+	extern volatile size_t sink;
+
+	inline void keep(bool val) noexcept {sink = sink + val;}
+	inline void keep(int val) noexcept {sink = sink + static_cast<size_t>(val);}
+	inline void keep(long long val) noexcept {sink = sink + static_cast<size_t>(val);}
+	inline void keep(double val) noexcept {sink = sink + static_cast<size_t>(val);}
+	inline void keep(const void* val) noexcept {sink = sink + reinterpret_cast<size_t>(val);}
+	inline void keep(const std::string& val) noexcept {sink = sink + val.size();}
+}
+
+
+//! Define a benchmark case. The body receives "context" and "iterations" (as members, so bodies may ignore either one).
+#define LUAPP_BENCH(operation, variant) \
+	namespace { \
+		struct Bench_##operation##_##variant { \
+			lua::Context& context; \
+			size_t iterations; \
+			void run(); \
+		}; \
+	} \
+	static void bench_##operation##_##variant(lua::Context& context, size_t iterations) \
+	{ \
+		Bench_##operation##_##variant{context, iterations}.run(); \
+	} \
+	static const bench::Registrar registrar_##operation##_##variant(#operation, #variant, bench_##operation##_##variant); \
+	void Bench_##operation##_##variant::run()
+
+#endif // HARNESS_H_INCLUDED
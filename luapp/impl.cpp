@@ -21,23 +21,97 @@
 
 #if defined(LUAPP_HEADER_ONLY_FLAG) || !defined(LUAPP_HEADER_ONLY)
 
+#include <cstring>
+#include <exception>
+#include <chrono>
+#include <sys/stat.h>
+
+// Platform headers for file mapping and file stamps (configuration macros are not left defined for the including code)
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#define LUAPP_UNDEF_NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#define LUAPP_UNDEF_WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#ifdef LUAPP_UNDEF_NOMINMAX
+#undef NOMINMAX
+#undef LUAPP_UNDEF_NOMINMAX
+#endif
+#ifdef LUAPP_UNDEF_WIN32_LEAN_AND_MEAN
+#undef WIN32_LEAN_AND_MEAN
+#undef LUAPP_UNDEF_WIN32_LEAN_AND_MEAN
+#endif
+#else	// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif	// _WIN32
+
 namespace lua {
 
 	namespace _ {
 
 //### mkcf ##################################################################################################################
+#if(LUAPP_API_VERSION >= 53)
+		LUAPP_HO_INLINE int LFunctionContinuation(lua_State* s, int, lua_KContext) noexcept
+#else
+		LUAPP_HO_INLINE int LFunctionContinuation(lua_State* s) noexcept
+#endif	// V53+
+		{
+			// The continuation is stored below the values passed to resume
+			LFunction k = reinterpret_cast<LFunction>(lua_touserdata(s, 1));
+			lua_remove(s, 1);
+			return LFunctionWrapper(k, s);
+		}
+
+
+
+		//! Yield the values on the top of the stack, optionally leaving the continuation as the only other stack slot
+		LUAPP_HO_INLINE int yieldValues(lua_State* s, int amount, LFunction continuation) noexcept
+		{
+#if(LUAPP_API_VERSION >= 52)
+			if(continuation) {
+				lua_pushlightuserdata(s, reinterpret_cast<void*>(continuation));
+				lua_insert(s, -amount - 1);
+				for(int below = lua_gettop(s) - amount - 1; below > 0; --below)
+					lua_remove(s, 1);
+				return lua_yieldk(s, amount, 0, LFunctionContinuation);
+			}
+#else
+			(void)continuation;
+#endif	// V52+
+			return lua_yield(s, amount);
+		}
+
+
+
 		LUAPP_HO_INLINE int LFunctionWrapper(LFunction f, lua_State* s) noexcept
 		{
 //			if(!f)
 //				return lua_error("Attempt to call null pointer as a Lua function");
+			// The error is raised (and the coroutine is yielded) outside of try block, when Context and all objects of the function are gone
+			int yielded = -1;
+			LFunction continuation = nullptr;
 			try {
 				Context S(s, Context::initializeExplicitly);
-				return f(S).rvamount;
+				const Retval& rv = f(S);
+				if(rv.isYield) {
+					yielded = static_cast<int>(rv.rvamount);
+					continuation = rv.continuation;
+				} else if(!rv.isError)
+					return rv.rvamount;
 			} catch(std::exception& e) {
-				return luaL_error(s, (std::string("Lua function terminated with an exception: ") + e.what()).c_str());
+				lua_pushfstring(s, "Lua function terminated with an exception: %s", e.what());
 			} catch(...) {
-				return luaL_error(s, "Lua function terminated with an unknown exception");
+				lua_pushstring(s, "Lua function terminated with an unknown exception");
 			}
+			if(yielded >= 0)
+				return yieldValues(s, yielded, continuation);
+			return lua_error(s);
 		}
 
 
@@ -47,13 +121,39 @@ namespace lua {
 			LFunction f = reinterpret_cast<LFunction>(lua_touserdata(s, lua_upvalueindex(1)));
 			if(!f)
 				return luaL_error(s, "LFunction wrapper: function pointer upvalue at index 1 is invalid");
-			try {
-				Context S(s, Context::initializeExplicitly);
-				return f(S).rvamount;
-			} catch(std::exception& e) {
-				return luaL_error(s, (std::string("Lua function terminated with an exception: ") + e.what()).c_str());
-			} catch(...) {
-				return luaL_error(s, "Lua function terminated with an unknown exception");
+			return LFunctionWrapper(f, s);
+		}
+
+
+		LUAPP_HO_INLINE int UDFinalizer(lua_State* s) noexcept
+		{
+			UDDestructor d = reinterpret_cast<UDDestructor>(lua_touserdata(s, lua_upvalueindex(1)));
+			// Only objects with the metatable this finalizer belongs to are destroyed (scripts can call "__gc" directly)
+			if(!d || lua_type(s, 1) != LUA_TUSERDATA || !lua_getmetatable(s, 1))
+				return 0;
+			const bool own = lua_rawequal(s, -1, lua_upvalueindex(2)) != 0;
+			lua_pop(s, 1);
+			if(own)
+			{
+				d(lua_touserdata(s, 1));
+				// Destroyed object is no longer recognized as user data of its type and cannot be destroyed again
+				lua_pushnil(s);
+				lua_setmetatable(s, 1);
+			}
+			return 0;
+		}
+
+
+		//! Push new metatable with "__gc" calling given destructor (if any)
+		LUAPP_HO_INLINE void pushUDMetatable(lua_State* s, UDDestructor destructor) noexcept
+		{
+			lua_newtable(s);
+			if(destructor)
+			{
+				lua_pushlightuserdata(s, reinterpret_cast<void*>(destructor));
+				lua_pushvalue(s, -2);
+				lua_pushcclosure(s, UDFinalizer, 2);
+				lua_setfield(s, -2, "__gc");
 			}
 		}
 
@@ -123,6 +223,496 @@ namespace lua {
 
 
 
+		LUAPP_HO_INLINE int loadChunkBuffer(lua_State* L, const char* data, size_t size, const char* name, ChunkMode mode) noexcept
+		{
+#if(LUAPP_API_VERSION >= 52)
+			static const char* const modes[] = {"t", "b", "bt"};
+			return luaL_loadbufferx(L, data, size, name, modes[static_cast<int>(mode)]);
+#else
+			const bool binary = size > 0 && data[0] == LUA_SIGNATURE[0];
+			if(mode != ChunkMode::Any && binary != (mode == ChunkMode::Binary))
+			{
+				lua_pushfstring(L, "attempt to load a %s chunk (mode is '%s')", binary ? "binary" : "text", binary ? "t" : "b");
+				return LUA_ERRSYNTAX;
+			}
+			return luaL_loadbuffer(L, data, size, name);
+#endif	// V52+
+		}
+
+
+		LUAPP_HO_INLINE void lazyBufferChunk::push(Context& S)
+		{
+			if(loadChunkBuffer(S, Data, Size, Name, Mode) != 0)
+			{
+				std::string errmsg = lua_tostring(S, -1);
+				lua_pop(S, 1);
+				throw std::runtime_error("Lua: could not load a chunk, the error message is: " + errmsg);
+			}
+		}
+
+
+
+		//! Read-only memory mapping of a whole file
+		class MappedFile {
+		public:
+			explicit MappedFile(const char* fileName) noexcept
+			{
+#ifdef _WIN32
+				const HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+				if(file == INVALID_HANDLE_VALUE)
+					return;
+				LARGE_INTEGER fileSize;
+				if(GetFileSizeEx(file, &fileSize))
+				{
+					opened = true;
+					size = static_cast<size_t>(fileSize.QuadPart);
+					if(size > 0)
+					{
+						const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+						if(mapping)
+						{
+							data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+							CloseHandle(mapping);
+						}
+						opened = data != nullptr;
+					}
+				}
+				CloseHandle(file);
+#else	// POSIX
+				const int file = open(fileName, O_RDONLY);
+				if(file < 0)
+					return;
+				struct stat info;
+				if(fstat(file, &info) == 0)
+				{
+					opened = true;
+					size = static_cast<size_t>(info.st_size);
+					if(size > 0)
+					{
+						void* const region = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+						if(region != MAP_FAILED)
+						{
+#ifdef MADV_SEQUENTIAL
+							madvise(region, size, MADV_SEQUENTIAL);
+#endif
+							data = static_cast<const char*>(region);
+						}
+						opened = data != nullptr;
+					}
+				}
+				close(file);
+#endif	// _WIN32
+			}
+
+			~MappedFile() noexcept
+			{
+				if(!data)
+					return;
+#ifdef _WIN32
+				UnmapViewOfFile(data);
+#else
+				munmap(const_cast<char*>(data), size);
+#endif	// _WIN32
+			}
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator = (const MappedFile&) = delete;
+
+			bool opened = false;
+			const char* data = nullptr;
+			size_t size = 0;
+		};
+
+
+
+		LUAPP_HO_INLINE void lazyMappedFileChunk::push(Context& S)
+		{
+			const MappedFile file(FileName);
+			if(!file.opened)
+				throw std::runtime_error(std::string("Lua: could not load a chunk, the error message is: cannot open ") + FileName);
+			const char* data = file.data ? file.data : "";
+			size_t size = file.size;
+			// Skip the first line if it starts with '#' (like luaL_loadfile does), keeping the line numbers intact
+			if(size > 0 && data[0] == '#')
+			{
+				const char* const eol = static_cast<const char*>(std::memchr(data, '\n', size));
+				const size_t skip = eol ? eol - data : size;
+				data += skip;
+				size -= skip;
+				if(size > 1 && data[1] == LUA_SIGNATURE[0])
+				{
+					++data;
+					--size;
+				}
+			}
+			const std::string name = std::string("@") + FileName;
+			if(loadChunkBuffer(S, data, size, name.c_str(), Mode) != 0)
+			{
+				std::string errmsg = lua_tostring(S, -1);
+				lua_pop(S, 1);
+				throw std::runtime_error("Lua: could not load a chunk, the error message is: " + errmsg);
+			}
+		}
+
+
+
+		struct ReadState {
+			ChunkReader reader;
+			void* data;
+			ChunkMode mode;
+			bool rejected;
+			std::exception_ptr error;
+		};
+
+
+		LUAPP_HO_INLINE const char* chunkReader(lua_State*, void* ud, size_t* size) noexcept
+		{
+			ReadState& state = *static_cast<ReadState*>(ud);
+			*size = 0;
+			if(state.error || state.rejected)
+				return nullptr;
+			try {
+				const StringRef piece = state.reader(state.data);
+				if(piece.size == 0)
+					return nullptr;
+#if(LUAPP_API_VERSION < 52)
+				// Lua 5.1 has no load mode, so the first piece is checked here
+				if(state.mode != ChunkMode::Any)
+				{
+					const bool binary = piece.data[0] == LUA_SIGNATURE[0];
+					state.rejected = binary != (state.mode == ChunkMode::Binary);
+					state.mode = ChunkMode::Any;
+					if(state.rejected)
+						return nullptr;
+				}
+#endif	// V51
+				*size = piece.size;
+				return piece.data;
+			} catch(...) {
+				state.error = std::current_exception();
+				return nullptr;
+			}
+		}
+
+
+		LUAPP_HO_INLINE void lazyReaderChunkUtils::load(lua_State* L, ChunkReader reader, void* data, const char* name, ChunkMode mode)
+		{
+			ReadState state{reader, data, mode, false, nullptr};
+#if(LUAPP_API_VERSION >= 52)
+			static const char* const modes[] = {"t", "b", "bt"};
+			const int status = lua_load(L, chunkReader, &state, name, modes[static_cast<int>(mode)]);
+#else
+			const int status = lua_load(L, chunkReader, &state, name);
+#endif	// V52+
+			if(state.error)
+			{
+				lua_pop(L, 1);
+				std::rethrow_exception(state.error);
+			}
+			if(state.rejected)
+			{
+				lua_pop(L, 1);
+				throw std::runtime_error(std::string("Lua: could not load a chunk, the error message is: attempt to load a ")
+					+ (mode == ChunkMode::Binary ? "text chunk (mode is 'b')" : "binary chunk (mode is 't')"));
+			}
+			if(status != 0)
+			{
+				std::string errmsg = lua_tostring(L, -1);
+				lua_pop(L, 1);
+				throw std::runtime_error("Lua: could not load a chunk, the error message is: " + errmsg);
+			}
+		}
+
+
+
+		struct DumpState {
+			DumpWriter writer;
+			void* data;
+			std::exception_ptr error;
+		};
+
+
+		LUAPP_HO_INLINE int dumpWriter(lua_State*, const void* data, size_t size, void* ud) noexcept
+		{
+			DumpState& state = *static_cast<DumpState*>(ud);
+			try {
+				state.writer(state.data, data, size);
+				return 0;
+			} catch(...) {
+				state.error = std::current_exception();
+				return 1;
+			}
+		}
+
+
+
+//### Chunk cache ###########################################################################################################
+// The cache is a table in the registry. Its array part holds the limit, the table of entries and the eviction queue
+// with its head and tail positions. Entries are {function, source, stamp} tables keyed by the source hash (a number
+// with exact representation, light user data keys are not portable to LuaJIT). Hash collisions are resolved by comparing
+// the source, a colliding entry is simply replaced. The queue holds keys in order of insertion, the oldest entry is evicted first.
+// The stamp is a binary string: empty for source text, modification time and size for files.
+
+		enum ChunkCacheFields {chunkCacheLimit = 1, chunkCacheEntries = 2, chunkCacheQueue = 3, chunkCacheHead = 4, chunkCacheTail = 5};
+		enum ChunkCacheEntry {chunkCacheFunction = 1, chunkCacheSource = 2, chunkCacheStamp = 3};
+		static const unsigned int chunkCacheDefaultLimit = 256;
+
+
+
+		LUAPP_HO_INLINE void* chunkCacheKey() noexcept
+		{
+			static char key;
+			return &key;
+		}
+
+
+
+		LUAPP_HO_INLINE lua_Number hashChunkSource(const char* source, size_t length, unsigned long long seed) noexcept
+		{
+			// FNV-1a, cut to 53 bits so that the hash is exactly representable by lua_Number
+			unsigned long long hash = seed;
+			for(size_t i = 0; i < length; ++i)
+				hash = (hash ^ static_cast<unsigned char>(source[i])) * 1099511628211ull;
+			return static_cast<lua_Number>(hash & 0x1FFFFFFFFFFFFFull);
+		}
+
+
+
+		LUAPP_HO_INLINE void newChunkCache(lua_State* L, lua_Number limit) noexcept
+		{
+			lua_createtable(L, 5, 0);
+			lua_pushnumber(L, limit);
+			lua_rawseti(L, -2, chunkCacheLimit);
+			lua_newtable(L);
+			lua_rawseti(L, -2, chunkCacheEntries);
+			lua_newtable(L);
+			lua_rawseti(L, -2, chunkCacheQueue);
+			lua_pushnumber(L, 1);
+			lua_rawseti(L, -2, chunkCacheHead);
+			lua_pushnumber(L, 1);
+			lua_rawseti(L, -2, chunkCacheTail);
+			lua_pushvalue(L, -1);
+#if(LUAPP_API_VERSION >= 52)
+			lua_rawsetp(L, LUA_REGISTRYINDEX, chunkCacheKey());
+#else
+			lua_pushlightuserdata(L, chunkCacheKey());
+			lua_insert(L, -2);
+			lua_rawset(L, LUA_REGISTRYINDEX);
+#endif	// V52+
+		}
+
+
+
+		LUAPP_HO_INLINE void pushChunkCache(lua_State* L) noexcept
+		{
+#if(LUAPP_API_VERSION >= 52)
+			lua_rawgetp(L, LUA_REGISTRYINDEX, chunkCacheKey());
+#else
+			lua_pushlightuserdata(L, chunkCacheKey());
+			lua_rawget(L, LUA_REGISTRYINDEX);
+#endif	// V52+
+			if(lua_isnil(L, -1))
+			{
+				lua_pop(L, 1);
+				newChunkCache(L, chunkCacheDefaultLimit);
+			}
+		}
+
+
+
+		LUAPP_HO_INLINE lua_Number getChunkCacheField(lua_State* L, int cache, int field) noexcept
+		{
+			lua_rawgeti(L, cache, field);
+			const lua_Number rv = lua_tonumber(L, -1);
+			lua_pop(L, 1);
+			return rv;
+		}
+
+
+
+		LUAPP_HO_INLINE void setChunkCacheField(lua_State* L, int cache, int field, lua_Number value) noexcept
+		{
+			lua_pushnumber(L, value);
+			lua_rawseti(L, cache, field);
+		}
+
+
+
+		LUAPP_HO_INLINE lua_Number chunkCacheCount(lua_State* L, int cache) noexcept
+		{
+			return getChunkCacheField(L, cache, chunkCacheTail) - getChunkCacheField(L, cache, chunkCacheHead);
+		}
+
+
+
+		//! Removes the oldest entry.
+		LUAPP_HO_INLINE void evictCachedChunk(lua_State* L, int cache) noexcept
+		{
+			const lua_Number head = getChunkCacheField(L, cache, chunkCacheHead);
+			lua_rawgeti(L, cache, chunkCacheEntries);
+			lua_rawgeti(L, cache, chunkCacheQueue);
+			lua_pushnumber(L, head);
+			lua_rawget(L, -2);			// entries, queue, key
+			lua_pushnil(L);
+			lua_rawset(L, -4);			// entries[key] = nil
+			lua_pushnumber(L, head);
+			lua_pushnil(L);
+			lua_rawset(L, -3);			// queue[head] = nil
+			lua_pop(L, 2);
+			setChunkCacheField(L, cache, chunkCacheHead, head + 1);
+		}
+
+
+
+		//! Pushes cached function and returns true if the entry is found.
+		LUAPP_HO_INLINE bool fetchCachedChunk(lua_State* L, int cache, lua_Number key, const char* source, size_t length, const char* stamp, size_t stampLength) noexcept
+		{
+			lua_rawgeti(L, cache, chunkCacheEntries);
+			lua_pushnumber(L, key);
+			lua_rawget(L, -2);
+			lua_remove(L, -2);
+			if(lua_istable(L, -1))
+			{
+				lua_rawgeti(L, -1, chunkCacheSource);
+				size_t cachedLength = 0;
+				const char* cachedSource = lua_tolstring(L, -1, &cachedLength);
+				lua_rawgeti(L, -2, chunkCacheStamp);
+				size_t cachedStampLength = 0;
+				const char* cachedStamp = lua_tolstring(L, -1, &cachedStampLength);
+				const bool hit = cachedLength == length && cachedStampLength == stampLength
+					&& std::memcmp(cachedStamp, stamp, stampLength) == 0 && std::memcmp(cachedSource, source, length) == 0;
+				lua_pop(L, 2);
+				if(hit)
+				{
+					lua_rawgeti(L, -1, chunkCacheFunction);
+					lua_remove(L, -2);
+					return true;
+				}
+			}
+			lua_pop(L, 1);
+			return false;
+		}
+
+
+
+		//! Stores the function on the top of the stack, the function remains on the stack.
+		LUAPP_HO_INLINE void storeCachedChunk(lua_State* L, int cache, lua_Number key, const char* source, size_t length, const char* stamp, size_t stampLength) noexcept
+		{
+			const lua_Number limit = getChunkCacheField(L, cache, chunkCacheLimit);
+			if(limit <= 0)
+				return;
+			lua_rawgeti(L, cache, chunkCacheEntries);
+			const int entries = lua_gettop(L);
+			lua_pushnumber(L, key);
+			lua_rawget(L, entries);
+			const bool replacing = !lua_isnil(L, -1);
+			lua_pop(L, 1);
+			if(!replacing)
+			{
+				if(chunkCacheCount(L, cache) >= limit)
+					evictCachedChunk(L, cache);
+				const lua_Number tail = getChunkCacheField(L, cache, chunkCacheTail);
+				lua_rawgeti(L, cache, chunkCacheQueue);
+				lua_pushnumber(L, tail);
+				lua_pushnumber(L, key);
+				lua_rawset(L, -3);
+				lua_pop(L, 1);
+				setChunkCacheField(L, cache, chunkCacheTail, tail + 1);
+			}
+			lua_pushnumber(L, key);
+			lua_createtable(L, 3, 0);
+			lua_pushvalue(L, entries - 1);
+			lua_rawseti(L, -2, chunkCacheFunction);
+			lua_pushlstring(L, source, length);
+			lua_rawseti(L, -2, chunkCacheSource);
+			lua_pushlstring(L, stamp, stampLength);
+			lua_rawseti(L, -2, chunkCacheStamp);
+			lua_rawset(L, entries);
+			lua_pop(L, 1);
+		}
+
+
+
+		//! Modification time (with the best resolution available) and size of the file, false if the file is not accessible.
+		LUAPP_HO_INLINE bool fileStamp(const char* fileName, long long (&stamp)[3]) noexcept
+		{
+#ifdef _WIN32
+			WIN32_FILE_ATTRIBUTE_DATA info;
+			if(!GetFileAttributesExA(fileName, GetFileExInfoStandard, &info))
+				return false;
+			stamp[0] = static_cast<long long>(info.ftLastWriteTime.dwHighDateTime) << 32 | info.ftLastWriteTime.dwLowDateTime;	// 100 ns units
+			stamp[1] = 0;
+			stamp[2] = static_cast<long long>(info.nFileSizeHigh) << 32 | info.nFileSizeLow;
+#else	// POSIX
+			struct stat info;
+			if(stat(fileName, &info) != 0)
+				return false;
+			stamp[0] = static_cast<long long>(info.st_mtime);
+#ifdef __APPLE__
+			stamp[1] = static_cast<long long>(info.st_mtimespec.tv_nsec);
+#else
+			stamp[1] = static_cast<long long>(info.st_mtim.tv_nsec);
+#endif	// __APPLE__
+			stamp[2] = static_cast<long long>(info.st_size);
+#endif	// _WIN32
+			return true;
+		}
+
+
+
+		//! Removes the error message and the cache table from the stack and throws.
+		LUAPP_HO_INLINE void failCachedChunk(lua_State* L)
+		{
+			std::string errmsg = lua_tostring(L, -1);
+			lua_pop(L, 2);
+			throw std::runtime_error("Lua: could not load a chunk, the error message is: " + errmsg);
+		}
+
+
+
+		LUAPP_HO_INLINE void lazyCachedChunk::push(Context& S)
+		{
+			pushChunkCache(S);
+			const int cache = lua_gettop(S);
+			const lua_Number key = hashChunkSource(ChunkText, Length, 14695981039346656037ull);
+			if(!fetchCachedChunk(S, cache, key, ChunkText, Length, "", 0))
+			{
+				if(luaL_loadbuffer(S, ChunkText, Length, ChunkText) != 0)
+					failCachedChunk(S);
+				storeCachedChunk(S, cache, key, ChunkText, Length, "", 0);
+			}
+			lua_remove(S, cache);
+		}
+
+
+
+		LUAPP_HO_INLINE void lazyCachedFileChunk::push(Context& S)
+		{
+			pushChunkCache(S);
+			const int cache = lua_gettop(S);
+			long long stamp[3];
+			if(!fileStamp(FileName, stamp))
+			{
+				// Let Lua produce the error message
+				if(luaL_loadfile(S, FileName) != 0)
+					failCachedChunk(S);
+				lua_remove(S, cache);
+				return;
+			}
+			const size_t length = std::strlen(FileName);
+			const char* const stampData = reinterpret_cast<const char*>(stamp);
+			const lua_Number key = hashChunkSource(FileName, length, 14695981039346656037ull ^ 0xFFu);
+			if(!fetchCachedChunk(S, cache, key, FileName, length, stampData, sizeof(stamp)))
+			{
+				if(luaL_loadfile(S, FileName) != 0)
+					failCachedChunk(S);
+				storeCachedChunk(S, cache, key, FileName, length, stampData, sizeof(stamp));
+			}
+			lua_remove(S, cache);
+		}
+
+
+
 
 //### C function wrappers ###################################################################################################
 
@@ -175,6 +765,8 @@ namespace lua {
 		LUAPP_HO_INLINE void lazyConstIndexerUtils::writeValue(lua_State* L, int tableref) noexcept
 		{
 			lua_settable(L, tableref);
+			if(tableref == LUA_REGISTRYINDEX)
+				udGeneration().fetch_add(1, std::memory_order_acq_rel);	// user data metatable may be replaced
 		}
 
 #if(LUAPP_API_VERSION >= 53)
@@ -519,20 +1111,65 @@ namespace lua {
 
 
 
+	template<> LUAPP_HO_INLINE StringRef Valref::cast<StringRef>() const
+	{
+		size_t len = 0;
+		const char* const rv = lua_tolstring(context, index, &len);
+		if(!rv)
+			throw std::runtime_error("Lua: bad cast to string reference");
+		return StringRef{rv, len};
+	}
+
+
+
+	template<> LUAPP_HO_INLINE StringRef Valref::to<StringRef>() const
+	{
+		size_t len = 0;
+		const char* const rv = lua_tolstring(context, index, &len);
+		return StringRef{rv, len};
+	}
+
+
+
 	template<> LUAPP_HO_INLINE std::string Valref::cast<std::string>() const
 	{
-		const char* const rv = lua_tostring(context, index);
+		size_t len = 0;
+		const char* const rv = lua_tolstring(context, index, &len);
 		if(!rv)
 			throw std::runtime_error("Lua: bad cast to std::string");
-		return rv;
+		return std::string(rv, len);
 	}
 
 
 
 	template<> LUAPP_HO_INLINE std::string Valref::to<std::string>() const
 	{
-		return lua_tostring(context, index);
+		size_t len = 0;
+		const char* const rv = lua_tolstring(context, index, &len);
+		return rv ? std::string(rv, len) : std::string();
+	}
+
+
+
+#ifdef LUAPP_STRING_VIEW
+	template<> LUAPP_HO_INLINE std::string_view Valref::cast<std::string_view>() const
+	{
+		size_t len = 0;
+		const char* const rv = lua_tolstring(context, index, &len);
+		if(!rv)
+			throw std::runtime_error("Lua: bad cast to std::string_view");
+		return std::string_view(rv, len);
+	}
+
+
+
+	template<> LUAPP_HO_INLINE std::string_view Valref::to<std::string_view>() const
+	{
+		size_t len = 0;
+		const char* const rv = lua_tolstring(context, index, &len);
+		return rv ? std::string_view(rv, len) : std::string_view();
 	}
+#endif	// LUAPP_STRING_VIEW
 
 
 
@@ -624,6 +1261,18 @@ namespace lua {
 		return is<const char*>();
 	}
 
+	template<> LUAPP_HO_INLINE bool Valref::is<StringRef>() const noexcept
+	{
+		return is<const char*>();
+	}
+
+#ifdef LUAPP_STRING_VIEW
+	template<> LUAPP_HO_INLINE bool Valref::is<std::string_view>() const noexcept
+	{
+		return is<const char*>();
+	}
+#endif	// LUAPP_STRING_VIEW
+
 	template<> LUAPP_HO_INLINE bool Valref::is<CFunction>() const noexcept
 	{
 		return lua_iscfunction(context, index) != 0;
@@ -687,6 +1336,7 @@ namespace lua {
 	LUAPP_HO_INLINE Valref::operator float() const {return cast<float>();}
 	LUAPP_HO_INLINE Valref::operator double() const {return cast<double>();}
 	LUAPP_HO_INLINE Valref::operator const char* () const  {return cast<const char*>();}
+	LUAPP_HO_INLINE Valref::operator std::string () const  {return cast<std::string>();}
 	LUAPP_HO_INLINE Valref::operator CFunction () const {return cast<CFunction>();}
 	LUAPP_HO_INLINE Valref::operator LightUserData () const {return cast<LightUserData>();}
 
@@ -697,32 +1347,40 @@ namespace lua {
 	}
 
 
-	LUAPP_HO_INLINE void* Valref::readUserData(const char* classname) const
+	LUAPP_HO_INLINE void* Valref::readUserData(const char* classname, _::UDCache& cache) const
 	{
-		if(!isUserData(classname))
+		if(!isUserData(classname, cache))
 			throw std::runtime_error("Lua: cast to user data failed");
 		return lua_touserdata(context, index);
 	}
 
 
-	LUAPP_HO_INLINE bool Valref::isUserData(const char* classname) const noexcept
+	LUAPP_HO_INLINE bool Valref::isUserData(const char* classname, _::UDCache& cache) const noexcept
 	{
-		const bool is_userdata = lua_isuserdata(context, index);
-		if(is_userdata)
+		if(lua_type(context, index) != LUA_TUSERDATA || !lua_getmetatable(context, index))
+			return false;
+		const void* const metatable = lua_topointer(context, -1);
+		const void* const registry = lua_topointer(context, LUA_REGISTRYINDEX);
+		const unsigned int generation = _::udGeneration().load(std::memory_order_acquire);
+		// Fast path: metatable is the one that matched this type last time
+		if(metatable == cache.metatable && registry == cache.registry && generation == cache.generation)
 		{
-			const bool got_mt = lua_getmetatable(context, index);
-			if(got_mt)
-			{
-				lua_pushstring(context, classname);
-				lua_gettable(context, LUA_REGISTRYINDEX);
-				const bool rv = lua_rawequal(context, -1, -2);
-				lua_pop(context, 2);
-				return rv;
-			}
+			lua_pop(context, 1);
+			return true;
 		}
-		return false;
-	}
-
+		// Slow path: look the metatable up by name and remember it if it matches
+		lua_getfield(context, LUA_REGISTRYINDEX, classname);
+		const bool rv = lua_rawequal(context, -1, -2) != 0;
+		lua_pop(context, 2);
+		if(rv)
+		{
+			cache.registry = registry;
+			cache.metatable = metatable;
+			cache.generation = generation;
+		}
+		return rv;
+	}
+
 
 #if(LUAPP_API_VERSION >= 52)
 	LUAPP_HO_INLINE size_t Valref::rawlen() const noexcept
@@ -854,6 +1512,13 @@ namespace lua {
 
 
 
+	LUAPP_HO_INLINE void Context::push(StringRef val) noexcept
+	{
+		lua_pushlstring(L, val.data, val.size);
+	}
+
+
+
 	LUAPP_HO_INLINE void Context::push(CFunction val) noexcept
 	{
 		lua_pushcfunction(L, val);
@@ -943,6 +1608,41 @@ namespace lua {
 
 
 
+	LUAPP_HO_INLINE void Context::newUDMetatable(const char* mtrefname, _::UDDestructor destructor) noexcept
+	{
+		_::pushUDMetatable(L, destructor);
+		lua_setfield(L, LUA_REGISTRYINDEX, mtrefname);
+		_::udGeneration().fetch_add(1, std::memory_order_acq_rel);
+	}
+
+
+
+	LUAPP_HO_INLINE void Context::setupGcUD(void* key, _::UDDestructor destructor) noexcept
+	{
+#if(LUAPP_API_VERSION >= 52)
+		lua_rawgetp(L, LUA_REGISTRYINDEX, key);
+#else
+		lua_pushlightuserdata(L, key);
+		lua_rawget(L, LUA_REGISTRYINDEX);
+#endif	// V52+
+		if(lua_isnil(L, -1))
+		{
+			lua_pop(L, 1);
+			_::pushUDMetatable(L, destructor);
+			lua_pushvalue(L, -1);
+#if(LUAPP_API_VERSION >= 52)
+			lua_rawsetp(L, LUA_REGISTRYINDEX, key);
+#else
+			lua_pushlightuserdata(L, key);
+			lua_insert(L, -2);
+			lua_rawset(L, LUA_REGISTRYINDEX);
+#endif	// V52+
+		}
+		lua_setmetatable(L, -2);
+	}
+
+
+
 	LUAPP_HO_INLINE void Context::gcCollect() noexcept
 	{
 		lua_gc(L, LUA_GCCOLLECT, 0);
@@ -978,6 +1678,97 @@ namespace lua {
 
 
 
+	LUAPP_HO_INLINE void Context::dumpTop(_::DumpWriter writer, void* data, bool strip)
+	{
+		_::DumpState state{writer, data, nullptr};
+#if(LUAPP_API_VERSION >= 53)
+		const int status = lua_dump(L, _::dumpWriter, &state, strip);
+#else
+		(void)strip;
+		const int status = lua_dump(L, _::dumpWriter, &state);
+#endif	// V53+
+		pop();
+		if(state.error)
+			std::rethrow_exception(state.error);
+		if(status != 0)
+			throw std::runtime_error("Lua: could not dump a function (only Lua functions can be dumped)");
+	}
+
+
+
+	LUAPP_HO_INLINE void Context::setChunkCacheLimit(unsigned int limit) noexcept
+	{
+		_::pushChunkCache(L);
+		const int cache = lua_gettop(L);
+		// Drop the oldest entries down to the new limit
+		for(lua_Number count = _::chunkCacheCount(L, cache); count > limit; --count)
+			_::evictCachedChunk(L, cache);
+		_::setChunkCacheField(L, cache, _::chunkCacheLimit, limit);
+		lua_pop(L, 1);
+	}
+
+
+
+	LUAPP_HO_INLINE void Context::clearChunkCache() noexcept
+	{
+		_::pushChunkCache(L);
+		const lua_Number limit = _::getChunkCacheField(L, -1, _::chunkCacheLimit);
+		lua_pop(L, 1);
+		_::newChunkCache(L, limit);
+		lua_pop(L, 1);
+	}
+
+
+
+	LUAPP_HO_INLINE bool Context::gcStep(int kbytes) noexcept
+	{
+		return lua_gc(L, LUA_GCSTEP, kbytes) != 0;
+	}
+
+
+
+	LUAPP_HO_INLINE bool Context::gcStepFor(unsigned int microseconds) noexcept
+	{
+		typedef std::chrono::steady_clock Clock;
+		const Clock::time_point deadline = Clock::now() + std::chrono::microseconds(microseconds);
+		do {
+			if(lua_gc(L, LUA_GCSTEP, 0))
+				return true;
+		} while(Clock::now() < deadline);
+		return false;
+	}
+
+
+
+	LUAPP_HO_INLINE int Context::gcSetPause(int percent) noexcept
+	{
+		return lua_gc(L, LUA_GCSETPAUSE, percent);
+	}
+
+
+
+	LUAPP_HO_INLINE int Context::gcSetStepMultiplier(int percent) noexcept
+	{
+		return lua_gc(L, LUA_GCSETSTEPMUL, percent);
+	}
+
+
+#if(LUAPP_API_VERSION == 52)
+	LUAPP_HO_INLINE void Context::gcGenerational() noexcept
+	{
+		lua_gc(L, LUA_GCGEN, 0);
+	}
+
+
+
+	LUAPP_HO_INLINE void Context::gcIncremental() noexcept
+	{
+		lua_gc(L, LUA_GCINC, 0);
+	}
+#endif	// V52
+
+
+
 	LUAPP_HO_INLINE Retval Context::doerror() const
 	{
 		return Retval(lua_error(L));
@@ -1036,6 +1827,132 @@ namespace lua {
 	}
 
 
+
+	LUAPP_HO_INLINE void _::TableUtils::setNumbers(lua_State* S, int tableNum, int firstKey, const double* values, size_t count) noexcept
+	{
+		for(const double* const end = values + count; values != end; ++values, ++firstKey) {
+			lua_pushnumber(S, *values);
+			lua_rawseti(S, tableNum, firstKey);
+		}
+	}
+
+
+
+	LUAPP_HO_INLINE void _::TableUtils::setIntegers(lua_State* S, int tableNum, int firstKey, const long long* values, size_t count) noexcept
+	{
+		for(const long long* const end = values + count; values != end; ++values, ++firstKey) {
+			lua_pushinteger(S, static_cast<lua_Integer>(*values));
+			lua_rawseti(S, tableNum, firstKey);
+		}
+	}
+
+
+
+	LUAPP_HO_INLINE void _::TableUtils::setStrings(lua_State* S, int tableNum, int firstKey, const StringRef* values, size_t count) noexcept
+	{
+		for(const StringRef* const end = values + count; values != end; ++values, ++firstKey) {
+			lua_pushlstring(S, values->data, values->size);
+			lua_rawseti(S, tableNum, firstKey);
+		}
+	}
+
+
+
+	LUAPP_HO_INLINE int _::TableUtils::pushUDMetatable(lua_State* S, const char* classname) noexcept
+	{
+		luaL_getmetatable(S, classname);
+		return lua_gettop(S);
+	}
+
+
+
+	LUAPP_HO_INLINE void* _::TableUtils::newUD(lua_State* S, size_t size) noexcept
+	{
+		return lua_newuserdata(S, size);
+	}
+
+
+
+	LUAPP_HO_INLINE void _::TableUtils::setUD(lua_State* S, int tableNum, int mtNum, int key) noexcept
+	{
+		lua_pushvalue(S, mtNum);
+		lua_setmetatable(S, -2);
+		lua_rawseti(S, tableNum, key);
+	}
+
+
+
+	LUAPP_HO_INLINE size_t _::TableUtils::length(lua_State* S, int tableNum) noexcept
+	{
+#if(LUAPP_API_VERSION >= 52)
+		return lua_rawlen(S, tableNum);
+#else	// V51-
+		return lua_objlen(S, tableNum);
+#endif	// V52+
+	}
+
+
+
+	LUAPP_HO_INLINE size_t _::TableUtils::getNumbers(lua_State* S, int tableNum, int firstKey, double* values, size_t count) noexcept
+	{
+		size_t done = 0;
+		for(; done < count; ++done) {
+			lua_rawgeti(S, tableNum, firstKey + static_cast<int>(done));
+#if(LUAPP_API_VERSION >= 52)
+			int isnum = 0;
+			values[done] = static_cast<double>(lua_tonumberx(S, -1, &isnum));
+#else	// V51-
+			const int isnum = lua_isnumber(S, -1);
+			values[done] = static_cast<double>(lua_tonumber(S, -1));
+#endif	// V52+
+			lua_pop(S, 1);
+			if(!isnum)
+				break;
+		}
+		return done;
+	}
+
+
+
+	LUAPP_HO_INLINE void _::TableUtils::getValue(lua_State* S, int tableNum, int key) noexcept
+	{
+		lua_rawgeti(S, tableNum, key);
+	}
+
+
+
+	LUAPP_HO_INLINE bool _::TableUtils::nextPair(lua_State* S, int tableNum)
+	{
+		lua_pop(S, 1);
+		return lua_next(S, tableNum) != 0;
+	}
+
+
+
+	LUAPP_HO_INLINE void _::TableUtils::conversionError(size_t failures, long long firstKey)
+	{
+		std::string msg = "Lua: " + std::to_string(failures) + " table element(s) cannot be converted";
+		if(firstKey)
+			msg += ", first at index " + std::to_string(firstKey);
+		throw std::runtime_error(msg);
+	}
+
+
+
+	LUAPP_HO_INLINE void _::TableUtils::clearFrom(lua_State* S, int tableNum, int firstKey) noexcept
+	{
+		for(;; ++firstKey) {
+			lua_rawgeti(S, tableNum, firstKey);
+			const bool empty = lua_isnil(S, -1);
+			lua_pop(S, 1);
+			if(empty)
+				break;
+			lua_pushnil(S);
+			lua_rawseti(S, tableNum, firstKey);
+		}
+	}
+
+
 	// Table
 
 	LUAPP_HO_INLINE Table::Table(Context& S, size_t arrSize, size_t recSize) noexcept:
@@ -1073,6 +1990,85 @@ namespace lua {
 
 
 
+	namespace _ {
+
+		struct LibraryEntry {
+			unsigned int flag;
+			const char* name;
+			CFunction open;
+		};
+
+
+
+		LUAPP_HO_INLINE void openLibraries(lua_State* L, lib::Library libraries)
+		{
+			if(libraries == lib::all) {
+				luaL_openlibs(L);
+				return;
+			}
+			static const LibraryEntry entries[] = {
+#if(LUAPP_API_VERSION >= 52)
+				{lib::base, "_G", luaopen_base},
+				{lib::package, LUA_LOADLIBNAME, luaopen_package},
+				{lib::coroutine, LUA_COLIBNAME, luaopen_coroutine},
+#else
+				{lib::base, "", luaopen_base},
+				{lib::package, LUA_LOADLIBNAME, luaopen_package},
+#endif	// V52+
+				{lib::string, LUA_STRLIBNAME, luaopen_string},
+				{lib::table, LUA_TABLIBNAME, luaopen_table},
+				{lib::math, LUA_MATHLIBNAME, luaopen_math},
+				{lib::io, LUA_IOLIBNAME, luaopen_io},
+				{lib::os, LUA_OSLIBNAME, luaopen_os},
+				{lib::debug, LUA_DBLIBNAME, luaopen_debug},
+#if(LUAPP_API_VERSION == 52)
+				{lib::bit32, LUA_BITLIBNAME, luaopen_bit32},
+#endif	// V52
+#if(LUAPP_API_VERSION >= 53)
+				{lib::utf8, LUA_UTF8LIBNAME, luaopen_utf8},
+#endif	// V53+
+			};
+			for(const LibraryEntry& entry: entries)
+				if(libraries & entry.flag) {
+#if(LUAPP_API_VERSION >= 52)
+					luaL_requiref(L, entry.name, entry.open, 1);
+					lua_pop(L, 1);
+#else
+					lua_pushcfunction(L, entry.open);
+					lua_pushstring(L, entry.name);
+					lua_call(L, 1, 0);
+#endif	// V52+
+				}
+		}
+
+	}
+
+
+
+	LUAPP_HO_INLINE State::State(lib::Library libraries):
+		state(luaL_newstate())
+	{
+		if(!state)
+			throw std::runtime_error("Lua state cannot be created");
+		lua_gc(state, LUA_GCSTOP, 0);
+		_::openLibraries(state, libraries);
+		lua_gc(state, LUA_GCRESTART, 0);
+	}
+
+
+
+	LUAPP_HO_INLINE State::State(void* (customAllocatorFunction) (void* /*ud*/, void* ptr, size_t oldSize, size_t newSize), void* ud, lib::Library libraries):
+		state(lua_newstate(customAllocatorFunction, ud))
+	{
+		if(!state)
+			throw std::runtime_error("Lua state cannot be created");
+		lua_gc(state, LUA_GCSTOP, 0);
+		_::openLibraries(state, libraries);
+		lua_gc(state, LUA_GCRESTART, 0);
+	}
+
+
+
 	LUAPP_HO_INLINE State::State(void* (customAllocatorFunction) (void* /*ud*/, void* ptr, size_t oldSize, size_t newSize), void* ud):
 		state(lua_newstate(customAllocatorFunction, ud))
 	{
@@ -1088,7 +2084,10 @@ namespace lua {
 	LUAPP_HO_INLINE State::~State() noexcept
 	{
 		if(state)
+		{
 			lua_close(state);
+			_::udGeneration().fetch_add(1, std::memory_order_acq_rel);	// addresses of metatables may be reused
+		}
 	}
 
 
@@ -1129,6 +2128,185 @@ namespace lua {
 
 
 
+	LUAPP_HO_INLINE void State::runBytecode(const void* data, size_t size, const char* name)
+	{
+		const auto oldtop = lua_gettop(state);
+		const bool success = _::loadChunkBuffer(state, static_cast<const char*>(data), size, name, ChunkMode::Binary) == 0 && lua_pcall(state, 0, LUA_MULTRET, 0) == 0;
+		if(success){
+			lua_settop(state, oldtop);
+		} else {
+			const auto newtop = lua_gettop(state);
+			const std::string msg(lua_isstring(state, newtop) ? lua_tostring(state, newtop) : _::strangeError);
+			lua_settop(state, oldtop);
+			throw std::runtime_error(msg);
+		}
+	}
+
+
+
+	namespace _ {
+
+		LUAPP_HO_INLINE void* globalsSnapshotKey() noexcept
+		{
+			static char key;
+			return &key;
+		}
+
+
+
+		LUAPP_HO_INLINE void pushGlobals(lua_State* L)
+		{
+#if(LUAPP_API_VERSION >= 52)
+			lua_rawgeti(L, LUA_REGISTRYINDEX, LUA_RIDX_GLOBALS);
+#else
+			lua_pushvalue(L, LUA_GLOBALSINDEX);
+#endif	// V52+
+		}
+
+
+
+		//! Push shallow copy of the table at absolute index
+		LUAPP_HO_INLINE void copyTable(lua_State* L, int source)
+		{
+			lua_newtable(L);
+			lua_pushnil(L);
+			while(lua_next(L, source)) {
+				lua_pushvalue(L, -2);
+				lua_insert(L, -2);
+				lua_rawset(L, -4);
+			}
+		}
+
+
+
+		//! Make the table at absolute index "target" a shallow copy of the table at absolute index "snapshot"
+		LUAPP_HO_INLINE void restoreTable(lua_State* L, int target, int snapshot)
+		{
+			// Existing fields can be changed or cleared during traversal
+			lua_pushnil(L);
+			while(lua_next(L, target)) {
+				lua_pushvalue(L, -2);
+				lua_rawget(L, snapshot);
+				if(!lua_rawequal(L, -1, -2)) {
+					lua_pushvalue(L, -3);
+					lua_insert(L, -2);
+					lua_rawset(L, target);
+					lua_pop(L, 1);
+				} else
+					lua_pop(L, 2);
+			}
+			// Removed fields are added back
+			lua_pushnil(L);
+			while(lua_next(L, snapshot)) {
+				lua_pushvalue(L, -2);
+				lua_rawget(L, target);
+				if(lua_isnil(L, -1)) {
+					lua_pop(L, 1);
+					lua_pushvalue(L, -2);
+					lua_insert(L, -2);
+					lua_rawset(L, target);
+				} else
+					lua_pop(L, 2);
+			}
+		}
+
+
+
+		// Snapshot fields
+		enum {snapGlobals = 1, snapLoaded, snapGlobalsMt, snapStringMt, snapStringMtCopy, snapHook, snapHookMask, snapHookCount};
+
+
+
+		LUAPP_HO_INLINE int saveGlobalsSnapshot(lua_State* L)
+		{
+			lua_settop(L, 0);
+			lua_pushlightuserdata(L, globalsSnapshotKey());
+			lua_createtable(L, snapHookCount, 0);
+			pushGlobals(L);
+			copyTable(L, 3);
+			lua_rawseti(L, 2, snapGlobals);
+			if(lua_getmetatable(L, 3))
+				lua_rawseti(L, 2, snapGlobalsMt);
+			lua_settop(L, 2);
+			lua_getfield(L, LUA_REGISTRYINDEX, "_LOADED");
+			if(lua_istable(L, 3)) {
+				copyTable(L, 3);
+				lua_rawseti(L, 2, snapLoaded);
+			}
+			lua_settop(L, 2);
+			lua_pushliteral(L, "");
+			if(lua_getmetatable(L, 3)) {
+				copyTable(L, 4);
+				lua_rawseti(L, 2, snapStringMtCopy);
+				lua_rawseti(L, 2, snapStringMt);
+			}
+			lua_settop(L, 2);
+			lua_pushlightuserdata(L, reinterpret_cast<void*>(lua_gethook(L)));
+			lua_rawseti(L, 2, snapHook);
+			lua_pushnumber(L, lua_gethookmask(L));
+			lua_rawseti(L, 2, snapHookMask);
+			lua_pushnumber(L, lua_gethookcount(L));
+			lua_rawseti(L, 2, snapHookCount);
+			lua_rawset(L, LUA_REGISTRYINDEX);
+			return 0;
+		}
+
+
+
+		LUAPP_HO_INLINE int restoreGlobalsSnapshot(lua_State* L)
+		{
+			lua_settop(L, 0);
+			lua_pushlightuserdata(L, globalsSnapshotKey());
+			lua_rawget(L, LUA_REGISTRYINDEX);
+			if(!lua_istable(L, 1))
+				return luaL_error(L, "Lua state: no saved globals to restore");
+			pushGlobals(L);
+			lua_rawgeti(L, 1, snapGlobals);
+			restoreTable(L, 2, 3);
+			lua_rawgeti(L, 1, snapGlobalsMt);
+			lua_setmetatable(L, 2);
+			lua_settop(L, 1);
+			lua_getfield(L, LUA_REGISTRYINDEX, "_LOADED");
+			lua_rawgeti(L, 1, snapLoaded);
+			if(lua_istable(L, 2) && lua_istable(L, 3))
+				restoreTable(L, 2, 3);
+			lua_settop(L, 1);
+			// String metatable is shared by all strings, so its fields are restored too
+			lua_pushliteral(L, "");
+			lua_rawgeti(L, 1, snapStringMt);
+			lua_rawgeti(L, 1, snapStringMtCopy);
+			if(lua_istable(L, 3) && lua_istable(L, 4))
+				restoreTable(L, 3, 4);
+			lua_pop(L, 1);
+			lua_setmetatable(L, 2);
+			lua_settop(L, 1);
+			// Hooks of the main thread (debug.sethook)
+			lua_rawgeti(L, 1, snapHook);
+			lua_rawgeti(L, 1, snapHookMask);
+			lua_rawgeti(L, 1, snapHookCount);
+			lua_sethook(L, reinterpret_cast<lua_Hook>(lua_touserdata(L, 2)), static_cast<int>(lua_tonumber(L, 3)), static_cast<int>(lua_tonumber(L, 4)));
+			return 0;
+		}
+
+	}
+
+
+
+	LUAPP_HO_INLINE void State::saveGlobals()
+	{
+		call(_::saveGlobalsSnapshot);
+	}
+
+
+
+	LUAPP_HO_INLINE void State::restoreGlobals()
+	{
+		lua_settop(state, 0);
+		call(_::restoreGlobalsSnapshot);
+	}
+
+
+
 	LUAPP_HO_INLINE void State::call(CFunction f)
 	{
 		const auto oldtop = lua_gettop(state);
@@ -1144,6 +2322,66 @@ namespace lua {
 		}
 	}
 
+
+
+//### Coroutine #############################################################################################################
+
+	LUAPP_HO_INLINE lua_State* Coroutine::newThread() noexcept
+	{
+		lua_State* const t = lua_newthread(owner);
+		anchor = luaL_ref(owner, LUA_REGISTRYINDEX);
+		return t;
+	}
+
+
+
+	LUAPP_HO_INLINE void Coroutine::start() noexcept
+	{
+		lua_xmove(owner, thread, 1);
+	}
+
+
+
+	LUAPP_HO_INLINE Coroutine::~Coroutine() noexcept
+	{
+		if(state != Status::Running)
+			lua_settop(thread, 0);	// drop the function of not started coroutine
+		luaL_unref(owner, LUA_REGISTRYINDEX, anchor);
+	}
+
+
+
+	LUAPP_HO_INLINE bool Coroutine::doResume(lua_State* from, int nargs, int rvAmount) noexcept
+	{
+		bool success;
+		int amount;
+		if(state != Status::Suspended || !lua_checkstack(thread, nargs)) {
+			lua_pop(from, nargs);
+			lua_pushstring(from, state == Status::Running ? "cannot resume non-suspended coroutine" :
+				state != Status::Suspended ? "cannot resume dead coroutine" : "stack overflow");
+			success = false;
+			amount = 1;
+		} else {
+			lua_xmove(from, thread, nargs);
+			state = Status::Running;
+#if(LUAPP_API_VERSION >= 52)
+			const int rc = lua_resume(thread, from, nargs);
+#else
+			const int rc = lua_resume(thread, nargs);
+#endif	// V52+
+			success = rc == 0 || rc == LUA_YIELD;
+			state = rc == LUA_YIELD ? Status::Suspended : success ? Status::Finished : Status::Failed;
+			amount = success ? lua_gettop(thread) : 1;
+			luaL_checkstack(from, amount, "too many results of coroutine");
+			lua_xmove(thread, from, amount);
+			if(!success)
+				lua_settop(thread, 0);
+		}
+		if(rvAmount >= 0)
+			lua_settop(from, lua_gettop(from) - amount + rvAmount);
+		return success;
+	}
+
 }
 
 #endif	// defined(LUAPP_HEADER_ONLY_FLAG) || !defined(LUAPP_HEADER_ONLY)
@@ -9,6 +9,7 @@
 #define LUA_HPP_INCLUDED
 
 #include <stdexcept>
+#include <atomic>
 #include <new>
 #include <iterator>
 #include <type_traits>
@@ -16,6 +17,14 @@
 #include <functional>
 #include <algorithm>
 #include <string>
+#include <tuple>
+#include <vector>
+
+#if(__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#include <string_view>
+#define LUAPP_STRING_VIEW
+#define LUAPP_NONTYPE_AUTO
+#endif	// C++17
 
 
 #ifdef LUAPP_COMPATIBILITY_V51
@@ -66,6 +75,10 @@ namespace lua {
 	//! @cond
 	namespace _ {
 		int LFunctionWrapper(LFunction f, lua_State* s) noexcept;
+
+		namespace wrap {
+			template<typename FP, FP fn, bool Fast> struct StaticCall;
+		}
 	}
 	//! @endcond
 
@@ -86,12 +99,62 @@ namespace lua {
 		return _::LFunctionWrapper(F, l);
 	}
 
+	//! @brief Wrapper for generic C/C++ function or member function known at compile time.
+	//! @details <code>template\<typename FP, FP fn\> wrapcf</code>\n
+	//! This template works like @ref lua::Context::wrap "Context::wrap", but the function pointer is a template argument,
+	//! so the wrapper is an individual C function: it doesn't need upvalues (no closure is allocated when it is pushed)
+	//! and doesn't read the function pointer at runtime. Example: @code{.cpp}
+	//! int someFunction(int x, const std::string& y);
+	//! CFunction cf = wrapcf<decltype(&someFunction), &someFunction>;
+	//! @endcode
+	//! @note Overloaded functions have to be cast to exact type first.
+	//! @sa LUAPP_ARG_CONVERT
+	//! @sa LUAPP_RV_CONVERT
+	template<typename FP, FP fn>
+	int wrapcf(lua_State* l)
+	{
+		return _::LFunctionWrapper(_::wrap::StaticCall<FP, fn, false>::call, l);
+	}
+
+#if defined(LUAPP_NONTYPE_AUTO) || defined(DOXYGEN_ONLY)
+	//! @brief Same as @ref wrapcf, but the function pointer type is deduced (C++17).
+	//! @details <code>template\<auto fn\> wrapStatic</code>\n
+	//! Example: @code{.cpp}
+	//! context.global["f"] = wrapStatic<&someFunction>;
+	//! @endcode
+	template<auto fn>
+	int wrapStatic(lua_State* l)
+	{
+		return _::LFunctionWrapper(_::wrap::StaticCall<decltype(fn), fn, false>::call, l);
+	}
+#endif	// LUAPP_NONTYPE_AUTO
+
+	//! @brief Same as @ref wrapcf, but with arguments verified all at once before conversion.
+	//! @details <code>template\<typename FP, FP fn\> fastwrapcf</code>\n
+	//! See @ref lua::Context::fastwrap "Context::fastwrap" for details.
+	template<typename FP, FP fn>
+	int fastwrapcf(lua_State* l)
+	{
+		return _::LFunctionWrapper(_::wrap::StaticCall<FP, fn, true>::call, l);
+	}
+
+#if defined(LUAPP_NONTYPE_AUTO) || defined(DOXYGEN_ONLY)
+	//! @brief Same as @ref fastwrapcf, but the function pointer type is deduced (C++17).
+	//! @details <code>template\<auto fn\> fastwrapStatic</code>
+	template<auto fn>
+	int fastwrapStatic(lua_State* l)
+	{
+		return _::LFunctionWrapper(_::wrap::StaticCall<decltype(fn), fn, true>::call, l);
+	}
+#endif	// LUAPP_NONTYPE_AUTO
+
 }
 
 #include "lua_context.hxx"
 #include "lua_wrap.hxx"
 #include "lua_impl.hxx"
 #include "lua_state.hxx"
+#include "lua_coroutine.hxx"
 
 
 //! @def LUAPP_USERDATA(type, class_name)
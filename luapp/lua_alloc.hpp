@@ -0,0 +1,459 @@
+/*
+* This file is part of Lua API++ library (https://github.com/OldFisher/lua-api-pp)
+* distributed under MIT License (http://opensource.org/licenses/MIT).
+* See license.txt for details.
+* (c) 2014 OldFisher
+*/
+
+#ifndef LUA_ALLOC_HPP_INCLUDED
+#define LUA_ALLOC_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+
+
+//! @file
+//! @brief Ready-made memory allocators for @ref lua::State "State" (optional, include separately).
+//! @details Every allocator object provides static function <code>allocate</code> compatible with lua_Alloc
+//! and the allocator object itself is used as user data pointer:
+//! @code{.cpp}
+//! lua::alloc::Pool pool;
+//! lua::State state(lua::alloc::Pool::allocate, &pool);
+//! @endcode
+//! Allocator object must outlive the state and must not be shared between states used by different threads.
+
+namespace lua {
+
+	//! @brief Memory allocators for Lua states.
+	namespace alloc {
+
+		//! @brief Default allocator based on realloc (same as the one used by luaL_newstate).
+		inline void* standard(void*, void* ptr, size_t /*oldSize*/, size_t newSize) noexcept
+		{
+			if(newSize == 0) {
+				std::free(ptr);
+				return nullptr;
+			}
+			return std::realloc(ptr, newSize);
+		}
+
+
+
+		//! @brief Size-class pool allocator.
+		//! @details Small blocks (up to @ref Pool::maxSmallSize bytes) are taken from per-size-class free lists
+		//! backed by large chunks, which suits Lua's distribution of small objects (short strings, tables, closures, upvalues).
+		//! Larger blocks and chunks are requested from another allocator (@ref standard by default).
+		//! Memory of small blocks is returned to the system only when the pool is destroyed.
+		//! Shrinking never fails: if a smaller block cannot be obtained, the old one is kept (a large block kept this way
+		//! joins the free lists and is not returned to the backend).
+		class Pool {
+		public:
+			//! @brief Type of delegated allocation function.
+			typedef void* (*AllocFunction)(void*, void*, size_t, size_t);
+
+			//! Granularity of size classes (also the alignment of small blocks).
+			static const size_t granularity = 16;
+			//! Biggest block served by free lists.
+			static const size_t maxSmallSize = 256;
+			//! Size of a chunk that small blocks are carved from.
+			static const size_t chunkSize = 64 * 1024;
+
+			//! @param backend Allocation function for chunks and large blocks.
+			//! @param backendUd User data pointer passed to backend.
+			explicit Pool(AllocFunction backend = &standard, void* backendUd = nullptr) noexcept:
+				backend(backend),
+				backendUd(backendUd)
+			{
+			}
+
+			~Pool() noexcept
+			{
+				while(chunks) {
+					Node* next = chunks->next;
+					backend(backendUd, chunks, chunkSize, 0);
+					chunks = next;
+				}
+			}
+
+			Pool(const Pool&) = delete;
+			Pool& operator = (const Pool&) = delete;
+
+			//! @brief lua_Alloc-compatible function, ud must point to Pool object.
+			static void* allocate(void* ud, void* ptr, size_t oldSize, size_t newSize) noexcept
+			{
+				Pool& pool = *static_cast<Pool*>(ud);
+				if(!ptr)
+					return newSize == 0 ? nullptr : pool.obtain(newSize);	// oldSize is a type hint here
+				if(newSize == 0) {
+					pool.release(ptr, oldSize);
+					return nullptr;
+				}
+				if(oldSize > maxSmallSize && newSize > maxSmallSize) {
+					void* const rv = pool.backend(pool.backendUd, ptr, oldSize, newSize);
+					return rv || newSize > oldSize ? rv : ptr;
+				}
+				if(oldSize <= maxSmallSize && newSize <= maxSmallSize && sizeClass(oldSize) == sizeClass(newSize))
+					return ptr;
+				void* const rv = pool.obtain(newSize);
+				if(rv) {
+					std::memcpy(rv, ptr, std::min(oldSize, newSize));
+					pool.release(ptr, oldSize);
+					return rv;
+				}
+				// Lua requires shrinking to succeed: keep the old block, it is big enough for the new size class.
+				// A large block kept this way is recycled by the free list and is never returned to the backend.
+				return newSize <= oldSize ? ptr : nullptr;
+			}
+
+		private:
+			struct Node {
+				Node* next;
+			};
+
+			static size_t sizeClass(size_t size) noexcept
+			{
+				return (size + granularity - 1) / granularity - 1;
+			}
+
+			void* obtain(size_t size) noexcept
+			{
+				if(size > maxSmallSize)
+					return backend(backendUd, nullptr, 0, size);
+				Node*& head = freeLists[sizeClass(size)];
+				if(head) {
+					Node* const rv = head;
+					head = rv->next;
+					return rv;
+				}
+				const size_t blockSize = (sizeClass(size) + 1) * granularity;
+				if(static_cast<size_t>(limit - cursor) < blockSize) {
+					// The rest of the current chunk is lost, it is smaller than any block in demand
+					char* const chunk = static_cast<char*>(backend(backendUd, nullptr, 0, chunkSize));
+					if(!chunk)
+						return nullptr;
+					reinterpret_cast<Node*>(chunk)->next = chunks;
+					chunks = reinterpret_cast<Node*>(chunk);
+					cursor = chunk + granularity;
+					limit = chunk + chunkSize;
+				}
+				void* const rv = cursor;
+				cursor += blockSize;
+				return rv;
+			}
+
+			void release(void* ptr, size_t size) noexcept
+			{
+				if(size > maxSmallSize) {
+					backend(backendUd, ptr, size, 0);
+					return;
+				}
+				Node* const node = static_cast<Node*>(ptr);
+				Node*& head = freeLists[sizeClass(size)];
+				node->next = head;
+				head = node;
+			}
+
+			// data
+			const AllocFunction backend;
+			void* const backendUd;
+			Node* freeLists[maxSmallSize / granularity] = {};
+			Node* chunks = nullptr;
+			char* cursor = nullptr;
+			char* limit = nullptr;
+		};
+
+
+
+		//! @brief Bump arena allocator for short-lived states.
+		//! @details Blocks are allocated sequentially from large chunks and are never reused individually:
+		//! freed memory is reclaimed only when the arena is @ref Arena::reset "reset" or destroyed.
+		//! The most recent block can grow and shrink in place. This makes allocation extremely cheap, but memory
+		//! consumption grows with all the garbage produced, so use it only for states that are closed soon.
+		class Arena {
+		public:
+			//! Alignment of allocated blocks.
+			static const size_t alignment = 16;
+
+			//! @param chunkSize Size of chunks requested from the system. Larger blocks get dedicated chunks.
+			explicit Arena(size_t chunkSize = 256 * 1024) noexcept:
+				chunkSize(chunkSize)
+			{
+			}
+
+			~Arena() noexcept
+			{
+				reset();
+			}
+
+			Arena(const Arena&) = delete;
+			Arena& operator = (const Arena&) = delete;
+
+			//! @brief Release all memory.
+			//! @pre The state using this arena must be closed already.
+			void reset() noexcept
+			{
+				while(chunks) {
+					Chunk* next = chunks->next;
+					std::free(chunks);
+					chunks = next;
+				}
+				cursor = limit = last = nullptr;
+				total = 0;
+			}
+
+			//! @brief Amount of memory requested from the system.
+			size_t reserved() const noexcept
+			{
+				return total;
+			}
+
+			//! @brief lua_Alloc-compatible function, ud must point to Arena object.
+			static void* allocate(void* ud, void* ptr, size_t oldSize, size_t newSize) noexcept
+			{
+				Arena& arena = *static_cast<Arena*>(ud);
+				if(!ptr)
+					oldSize = 0;	// it is a type hint, not a size
+				if(newSize == 0) {
+					if(ptr && ptr == arena.last) {
+						arena.cursor = arena.last;
+						arena.last = nullptr;
+					}
+					return nullptr;
+				}
+				if(ptr && ptr == arena.last && static_cast<size_t>(arena.limit - arena.last) >= align(newSize)) {
+					arena.cursor = arena.last + align(newSize);
+					return ptr;
+				}
+				if(ptr && newSize <= oldSize)
+					return ptr;
+				void* const rv = arena.obtain(newSize);
+				if(rv && ptr)
+					std::memcpy(rv, ptr, oldSize);
+				return rv;
+			}
+
+		private:
+			struct Chunk {
+				Chunk* next;
+			};
+
+			static size_t align(size_t size) noexcept
+			{
+				return (size + alignment - 1) & ~(alignment - 1);
+			}
+
+			void* obtain(size_t size) noexcept
+			{
+				size = align(size);
+				if(static_cast<size_t>(limit - cursor) < size) {
+					const size_t required = std::max(chunkSize, size + alignment);
+					char* const chunk = static_cast<char*>(std::malloc(required));
+					if(!chunk)
+						return nullptr;
+					reinterpret_cast<Chunk*>(chunk)->next = chunks;
+					chunks = reinterpret_cast<Chunk*>(chunk);
+					total += required;
+					cursor = chunk + alignment;
+					limit = chunk + required;
+				}
+				last = cursor;
+				cursor += size;
+				return last;
+			}
+
+			// data
+			const size_t chunkSize;
+			Chunk* chunks = nullptr;
+			char* cursor = nullptr;
+			char* limit = nullptr;
+			char* last = nullptr;
+			size_t total = 0;
+		};
+
+
+
+		//! @brief Allocator with a hard memory quota.
+		//! @details Requests that would bring the amount of memory in use past the quota fail
+		//! (Lua reports them as "not enough memory" errors), shrinking and freeing always succeed.
+		//! Actual allocation is delegated to another allocator (@ref standard by default).
+		class Limited {
+		public:
+			//! @brief Type of delegated allocation function.
+			typedef void* (*AllocFunction)(void*, void*, size_t, size_t);
+
+			//! @param quota Maximum amount of memory in use, in bytes.
+			//! @param backend Allocation function performing actual allocations.
+			//! @param backendUd User data pointer passed to backend.
+			explicit Limited(size_t quota, AllocFunction backend = &standard, void* backendUd = nullptr) noexcept:
+				quota(quota),
+				backend(backend),
+				backendUd(backendUd)
+			{
+			}
+
+			Limited(const Limited&) = delete;
+			Limited& operator = (const Limited&) = delete;
+
+			//! @brief Amount of memory in use, in bytes.
+			size_t used() const noexcept
+			{
+				return inUse;
+			}
+
+			//! @brief Current quota.
+			size_t getQuota() const noexcept
+			{
+				return quota;
+			}
+
+			//! @brief Change the quota.
+			//! @details Lowering the quota below the amount in use does not free anything, but all growing requests will fail.
+			void setQuota(size_t newQuota) noexcept
+			{
+				quota = newQuota;
+			}
+
+			//! @brief lua_Alloc-compatible function, ud must point to Limited object.
+			static void* allocate(void* ud, void* ptr, size_t oldSize, size_t newSize) noexcept
+			{
+				Limited& lim = *static_cast<Limited*>(ud);
+				const size_t accounted = ptr ? oldSize : 0;	// for new blocks oldSize is a type hint, not a size
+				if(newSize > accounted && newSize - accounted > lim.quota - std::min(lim.quota, lim.inUse))
+					return nullptr;
+				void* const rv = lim.backend(lim.backendUd, ptr, oldSize, newSize);
+				if(rv || newSize == 0)
+					lim.inUse = lim.inUse - accounted + newSize;
+				return rv;
+			}
+
+		private:
+			size_t quota;
+			const AllocFunction backend;
+			void* const backendUd;
+			size_t inUse = 0;
+		};
+
+
+
+		//! @brief Memory statistics collected by @ref Tracking allocator.
+		struct Stats {
+			//! Amount of histogram buckets.
+			static const size_t histogramSize = 24;
+			//! Amount of per-type slots.
+			static const size_t typeSlots = 16;
+
+			//! Per-type allocation counters.
+			struct TypeStats {
+				size_t count;		//!< Amount of blocks allocated.
+				size_t bytes;		//!< Total size of blocks allocated (at allocation time).
+			};
+
+			size_t liveBytes;		//!< Amount of memory in use.
+			size_t peakBytes;		//!< Maximum amount of memory in use.
+			size_t allocations;		//!< Amount of new blocks allocated.
+			size_t reallocations;	//!< Amount of blocks resized.
+			size_t frees;			//!< Amount of blocks freed.
+			size_t failures;		//!< Amount of failed requests.
+			//! @brief Requested sizes of new and resized blocks.
+			//! @details Bucket 0 counts requests up to 8 bytes, bucket N counts sizes in range (2<sup>N+2</sup>, 2<sup>N+3</sup>],
+			//! the last bucket also counts everything bigger.
+			size_t histogram[histogramSize];
+			//! @brief New blocks by Lua object type.
+			//! @details Indexed by type tag Lua passes to allocator for new objects (LUA_TSTRING, LUA_TTABLE, LUA_TFUNCTION etc., Lua 5.2+).
+			//! Variant tags are counted under their basic type (long strings under LUA_TSTRING, C closures under LUA_TFUNCTION),
+			//! internal object types (prototypes, upvalues) get slots past LUA_TTHREAD.
+			//! Slot 0 collects blocks without a type hint (Lua 5.1, arrays and internal buffers).
+			TypeStats byType[typeSlots];
+		};
+
+
+
+		//! @brief Allocator collecting memory statistics.
+		//! @details Actual allocation is delegated to another allocator (@ref standard by default), the overhead is
+		//! a handful of counter updates per request. Statistics are available through @ref Tracking::stats "stats" function.
+		class Tracking {
+		public:
+			//! @brief Type of delegated allocation function.
+			typedef void* (*AllocFunction)(void*, void*, size_t, size_t);
+
+			//! @param backend Allocation function performing actual allocations.
+			//! @param backendUd User data pointer passed to backend.
+			explicit Tracking(AllocFunction backend = &standard, void* backendUd = nullptr) noexcept:
+				backend(backend),
+				backendUd(backendUd)
+			{
+			}
+
+			Tracking(const Tracking&) = delete;
+			Tracking& operator = (const Tracking&) = delete;
+
+			//! @brief Collected statistics.
+			const Stats& stats() const noexcept
+			{
+				return data;
+			}
+
+			//! @brief Reset all counters except the amount of memory in use.
+			void reset() noexcept
+			{
+				const size_t live = data.liveBytes;
+				data = Stats();
+				data.liveBytes = data.peakBytes = live;
+			}
+
+			//! @brief lua_Alloc-compatible function, ud must point to Tracking object.
+			static void* allocate(void* ud, void* ptr, size_t oldSize, size_t newSize) noexcept
+			{
+				Tracking& tr = *static_cast<Tracking*>(ud);
+				Stats& st = tr.data;
+				void* const rv = tr.backend(tr.backendUd, ptr, oldSize, newSize);
+				if(newSize == 0) {
+					if(ptr) {
+						++st.frees;
+						st.liveBytes -= oldSize;
+					}
+					return rv;
+				}
+				if(!rv) {
+					++st.failures;
+					return rv;
+				}
+				++st.histogram[bucket(newSize)];
+				if(ptr) {
+					++st.reallocations;
+					st.liveBytes = st.liveBytes - oldSize + newSize;
+				} else {
+					++st.allocations;
+					st.liveBytes += newSize;
+					// low 4 bits of the tag hold the basic type, higher ones select the variant
+					Stats::TypeStats& type = st.byType[oldSize & (Stats::typeSlots - 1)];
+					++type.count;
+					type.bytes += newSize;
+				}
+				if(st.liveBytes > st.peakBytes)
+					st.peakBytes = st.liveBytes;
+				return rv;
+			}
+
+		private:
+			static size_t bucket(size_t size) noexcept
+			{
+				size_t rv = 0;
+				for(size_t limit = 8; size > limit && rv < Stats::histogramSize - 1; limit <<= 1)
+					++rv;
+				return rv;
+			}
+
+			const AllocFunction backend;
+			void* const backendUd;
+			Stats data = Stats();
+		};
+
+	}
+
+}
+
+#endif // LUA_ALLOC_HPP_INCLUDED
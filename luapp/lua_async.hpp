@@ -0,0 +1,587 @@
+/*
+* This file is part of Lua API++ library (https://github.com/OldFisher/lua-api-pp)
+* distributed under MIT License (http://opensource.org/licenses/MIT).
+* See license.txt for details.
+* (c) 2014 OldFisher
+*/
+
+#ifndef LUA_ASYNC_HPP_INCLUDED
+#define LUA_ASYNC_HPP_INCLUDED
+
+#include "lua.hpp"
+#include "luainc.h"
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+
+#if !defined(__cpp_impl_coroutine) && !defined(DOXYGEN_ONLY)
+#error "lua_async.hpp requires C++20 coroutines"
+#endif
+
+#if(LUAPP_API_VERSION < 52)
+#error "lua_async.hpp requires Lua 5.2 or newer (yield with continuation)"
+#endif
+
+
+
+//! @file
+//! @brief Bridge between C++20 coroutines and Lua coroutines (optional, include separately, requires C++20 and Lua 5.2+).
+
+namespace lua {
+
+	//! @brief C++20 coroutine support.
+	namespace async {
+
+		template<typename T> class Task;
+		class Scheduler;
+
+		//! @cond
+		namespace _ {
+
+			//! Completion tracking shared by all task promises
+			class PromiseBase {
+			public:
+				//! Arrange for handle to be resumed on completion, false if the task has already completed
+				bool attach(std::coroutine_handle<> waiter) noexcept
+				{
+					continuation = waiter;
+					return wait();
+				}
+
+				//! Arrange for callback to be called on completion, false if the task has already completed
+				bool attach(std::function<void()>&& callback) noexcept
+				{
+					onDone = std::move(callback);
+					return wait();
+				}
+
+				bool completed() const noexcept
+				{
+					return state.load(std::memory_order_acquire) == Completed;
+				}
+
+				std::suspend_never initial_suspend() noexcept
+				{
+					return {};
+				}
+
+				auto final_suspend() noexcept
+				{
+					struct FinalAwaiter {
+						bool await_ready() noexcept
+						{
+							return false;
+						}
+
+						std::coroutine_handle<> await_suspend(std::coroutine_handle<> ) noexcept
+						{
+							if(promise.state.exchange(Completed, std::memory_order_acq_rel) != Waiting)
+								return std::noop_coroutine();
+							if(promise.continuation)
+								return promise.continuation;
+							const std::function<void()> callback(std::move(promise.onDone));
+							callback();	// may destroy the coroutine
+							return std::noop_coroutine();
+						}
+
+						void await_resume() noexcept
+						{
+						}
+
+						PromiseBase& promise;
+					};
+					return FinalAwaiter{*this};
+				}
+
+				void unhandled_exception() noexcept
+				{
+					error = std::current_exception();
+				}
+
+			protected:
+				void rethrow() const
+				{
+					if(error)
+						std::rethrow_exception(error);
+				}
+
+			private:
+				enum {Running, Waiting, Completed};
+
+				bool wait() noexcept
+				{
+					int expected = Running;
+					return state.compare_exchange_strong(expected, Waiting, std::memory_order_acq_rel);
+				}
+
+				// data
+				std::atomic<int> state{Running};
+				std::coroutine_handle<> continuation;
+				std::function<void()> onDone;
+				std::exception_ptr error;
+			};
+
+			//! Result storage
+			template<typename T>
+			class Promise: public PromiseBase {
+			public:
+				Task<T> get_return_object() noexcept;
+
+				template<typename U>
+				void return_value(U&& val)
+				{
+					value.emplace(std::forward<U>(val));
+				}
+
+				T result()
+				{
+					rethrow();
+					return std::move(*value);
+				}
+
+			private:
+				std::optional<T> value;
+			};
+
+			template<>
+			class Promise<void>: public PromiseBase {
+			public:
+				Task<void> get_return_object() noexcept;
+
+				void return_void() noexcept
+				{
+				}
+
+				void result()
+				{
+					rethrow();
+				}
+			};
+
+			//! Marker of yields made by asynchronous functions
+			inline const char pendingMarker = 0;
+
+			//! Task awaited by suspended Lua coroutine
+			class PendingBase {
+			public:
+				virtual ~PendingBase() = default;
+				virtual bool attach(std::function<void()>&& callback) noexcept = 0;
+			};
+
+			template<typename T>
+			class Pending final: public PendingBase {
+			public:
+				explicit Pending(Task<T>&& t) noexcept:
+					task(std::move(t))
+				{
+				}
+
+				bool attach(std::function<void()>&& callback) noexcept override
+				{
+					return task.handle.promise().attach(std::move(callback));
+				}
+
+				Task<T> task;
+			};
+
+			//! Let incomplete task finish on its own (it may be referenced by an event loop) and destroy it afterwards
+			inline void orphan(PendingBase* p) noexcept
+			{
+				if(!p->attach([p]{ delete p; }))
+					delete p;
+			}
+
+			//! @brief Lua-side owner of the task yielded by wrapped function.
+			//! @details Scheduler takes the task when the yield reaches it. If the yield fails (C-call boundary) or lands in
+			//! coroutine.resume called by Lua code, the task is orphaned when the owner is collected.
+			struct PendingOwner {
+				~PendingOwner()
+				{
+					if(pending)
+						orphan(pending);
+				}
+
+				PendingBase* pending;
+			};
+
+			//! Check if the running function may yield
+			inline bool isYieldable(lua_State* L) noexcept
+			{
+#if(LUAPP_API_VERSION >= 53)
+				return lua_isyieldable(L) != 0;
+#else	// V52
+				const bool mainThread = lua_pushthread(L) != 0;
+				lua_pop(L, 1);
+				return !mainThread;
+#endif	// V52
+			}
+
+			//! Continuation of wrapped function: convert the result of completed task
+			template<typename T>
+			Retval finishPending(Context& c)
+			{
+				Pending<T>& p = *static_cast<Pending<T>*>(c.args.at(0).cast<LightUserData>());
+				if constexpr(std::is_void<T>::value) {
+					p.task.result();
+					return c.ret();
+				} else
+					return ::lua::_::wrap::rvCvt<T>(p.task.result(), c);
+			}
+
+		}
+		//! @endcond
+
+	}
+
+
+
+	//! @cond
+	template<>
+	struct UserData<async::_::PendingOwner> {
+		typedef void enabled;
+		static constexpr const char* const classname = "lua::async::Pending";
+	};
+	//! @endcond
+
+
+
+	namespace async {
+
+
+
+		//! @brief Result of C++ coroutine (eagerly started).
+		//! @details Wrapped functions (see @ref lua::Context::wrap "wrap", @ref lua::wrapcf "wrapcf" and the like) may return Task:
+		//! if the task is not complete when the function returns, the calling Lua coroutine yields and is resumed
+		//! by @ref Scheduler when the task completes. The task result is then converted to Lua values as usual.
+		//! Tasks may also be awaited by other tasks with <code>co_await</code>.
+		//! @code{.cpp}
+		//! lua::async::Task<std::string> fetch(std::string url)
+		//! {
+		//!     std::string reply = co_await client.get(url);   // some asynchronous operation
+		//!     co_return reply;
+		//! }
+		//! ...
+		//! context.global["fetch"] = lua::wrapStatic<&fetch>;
+		//! scheduler.spawn(context.chunk("print(fetch('http://example.com'))"));
+		//! scheduler.run();
+		//! @endcode
+		//! @note Task is move-only; destroying incomplete task destroys the coroutine.
+		//! @note The calling Lua coroutine must be run by Scheduler. If it cannot yield (e.g. inside table.sort comparator),
+		//! the wrapped function raises an error; if it was resumed by Lua code (coroutine.resume or coroutine.wrap), the yielded
+		//! values are meaningless there. In both cases the task is left to complete on its own and destroyed afterwards.
+		template<typename T>
+		class Task {
+			friend class _::Promise<T>;
+			friend class _::Pending<T>;
+
+		public:
+			typedef _::Promise<T> promise_type;
+
+			Task(Task&& src) noexcept:
+				handle(src.handle)
+			{
+				src.handle = nullptr;
+			}
+
+			Task& operator = (Task&& src) noexcept
+			{
+				if(this != &src) {
+					if(handle)
+						handle.destroy();
+					handle = src.handle;
+					src.handle = nullptr;
+				}
+				return *this;
+			}
+
+			~Task()
+			{
+				if(handle)
+					handle.destroy();
+			}
+
+			//! @brief Check if the task has completed.
+			bool done() const noexcept
+			{
+				return handle.promise().completed();
+			}
+
+			//! @brief Get the result of completed task (rethrows the exception that terminated it).
+			//! @pre done()
+			T result()
+			{
+				return handle.promise().result();
+			}
+
+			//! @cond
+			bool await_ready() const noexcept
+			{
+				return done();
+			}
+
+			bool await_suspend(std::coroutine_handle<> waiter) noexcept
+			{
+				return handle.promise().attach(waiter);
+			}
+
+			T await_resume()
+			{
+				return result();
+			}
+			//! @endcond
+
+		private:
+			explicit Task(std::coroutine_handle<promise_type> h) noexcept:
+				handle(h)
+			{
+			}
+
+			std::coroutine_handle<promise_type> handle;
+		};
+
+
+
+		//! @cond
+		namespace _ {
+
+			template<typename T>
+			inline Task<T> Promise<T>::get_return_object() noexcept
+			{
+				return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+			}
+
+			inline Task<void> Promise<void>::get_return_object() noexcept
+			{
+				return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+			}
+
+		}
+		//! @endcond
+
+
+
+		//! @brief Local executor running Lua coroutines that await C++ tasks.
+		//! @details Lua functions are @ref spawn "spawned" as Lua coroutines. When a wrapped function returns incomplete @ref Task,
+		//! its coroutine is suspended until the task completes, meanwhile other coroutines and posted jobs are executed.
+		//! Completions of asynchronous operations are delivered as @ref post "posted" jobs (post is thread-safe, so an I/O thread
+		//! or an event loop may deliver them), and the scheduler resumes the waiting Lua coroutine from its own thread.
+		//! Lua coroutines that yield by themselves (coroutine.yield) are simply resumed later, after other pending work.
+		//! @note All Lua code runs on the thread calling @ref run / @ref runOnce. Tasks should not touch Lua state while suspended.
+		class Scheduler {
+		public:
+			//! @brief Create scheduler for coroutines of given context.
+			explicit Scheduler(Context& context) noexcept:
+				S(context)
+			{
+			}
+
+			Scheduler(const Scheduler&) = delete;
+			Scheduler& operator = (const Scheduler&) = delete;
+
+			//! @brief Unfinished Lua coroutines and tasks they await are destroyed.
+			~Scheduler() = default;
+
+#ifdef DOXYGEN_ONLY
+			//! @brief Start a Lua function as a coroutine, it runs until its first suspension.
+			//! @throw std::runtime_error if the function raises an error.
+			void spawn(Valobj fn, Valobj... args);
+#else	// Not DOXYGEN_ONLY
+			template<typename Function, typename ... Args>
+			void spawn(Function&& fn, Args&& ... args)
+			{
+				tasks.emplace_back(std::forward<Function>(fn), S);
+				const auto it = std::prev(tasks.end());
+				Valset vs = it->coroutine.resume(std::forward<Args>(args)...);
+				advance(it, vs);
+			}
+#endif	// DOXYGEN_ONLY
+
+			//! @brief Queue a job for execution by the scheduler's thread (thread-safe).
+			void post(std::function<void()> job)
+			{
+				{
+					std::lock_guard<std::mutex> lock(guard);
+					jobs.push_back(std::move(job));
+				}
+				wake.notify_one();
+			}
+
+			//! @brief Awaitable that suspends a task and resumes it from the scheduler's queue.
+			auto schedule() noexcept
+			{
+				struct Awaiter {
+					bool await_ready() noexcept
+					{
+						return false;
+					}
+
+					void await_suspend(std::coroutine_handle<> h)
+					{
+						scheduler.post([h]{ h.resume(); });
+					}
+
+					void await_resume() noexcept
+					{
+					}
+
+					Scheduler& scheduler;
+				};
+				return Awaiter{*this};
+			}
+
+			//! @brief Execute jobs that are already queued, do not wait for more.
+			//! @return Amount of executed jobs.
+			//! @throw std::runtime_error if a Lua coroutine raises an error (it is dropped, the rest remain).
+			size_t runOnce()
+			{
+				std::deque<std::function<void()>> ready;
+				{
+					std::lock_guard<std::mutex> lock(guard);
+					ready.swap(jobs);
+				}
+				size_t done = 0;
+				try {
+					for(; !ready.empty(); ready.pop_front(), ++done)
+						ready.front()();
+				} catch(...) {
+					std::lock_guard<std::mutex> lock(guard);
+					jobs.insert(jobs.begin(), std::make_move_iterator(ready.begin() + 1), std::make_move_iterator(ready.end()));
+					throw;
+				}
+				return done;
+			}
+
+			//! @brief Run until all Lua coroutines finish, waiting for posted jobs when all of them are suspended.
+			//! @throw std::runtime_error if a Lua coroutine raises an error (it is dropped, the rest remain).
+			void run()
+			{
+				while(!tasks.empty() || hasJobs()) {
+					{
+						std::unique_lock<std::mutex> lock(guard);
+						wake.wait(lock, [this]{ return !jobs.empty(); });
+					}
+					runOnce();
+				}
+			}
+
+			//! @brief Amount of unfinished Lua coroutines.
+			size_t size() const noexcept
+			{
+				return tasks.size();
+			}
+
+		private:
+			struct Record {
+				template<typename Function>
+				Record(Function&& fn, Context& c):
+					coroutine(std::forward<Function>(fn), c)
+				{
+				}
+
+				Coroutine coroutine;
+				std::unique_ptr<_::PendingBase> pending;
+			};
+
+			typedef std::list<Record>::iterator Iterator;
+
+			bool hasJobs() const
+			{
+				std::lock_guard<std::mutex> lock(guard);
+				return !jobs.empty();
+			}
+
+			//! Resume the coroutine with the task it is waiting for (if any)
+			void step(Iterator it)
+			{
+				const std::unique_ptr<_::PendingBase> pending(std::move(it->pending));
+				if(pending) {
+					Valset vs = it->coroutine.resume(static_cast<LightUserData>(pending.get()));
+					advance(it, vs);
+				} else {
+					Valset vs = it->coroutine.resume();
+					advance(it, vs);
+				}
+			}
+
+			//! Process resumption results
+			void advance(Iterator it, const Valset& vs)
+			{
+				if(!vs.success()) {
+					const std::string msg = vs[0].type() == ValueType::String ? vs[0].cast<std::string>() : std::string("Lua: asynchronous task failed");
+					tasks.erase(it);
+					throw std::runtime_error(msg);
+				}
+				if(!it->coroutine.isResumable()) {
+					tasks.erase(it);
+					return;
+				}
+				if(vs.size() == 2 && vs[0].type() == ValueType::LightUserdata && vs[0].cast<LightUserData>() == &_::pendingMarker
+					&& vs[1].is<_::PendingOwner>()) {
+					_::PendingOwner& owner = vs[1].cast<_::PendingOwner>();
+					it->pending.reset(owner.pending);
+					owner.pending = nullptr;
+					if(it->pending->attach([this, it]{ post([this, it]{ step(it); }); }))
+						return;
+				}
+				post([this, it]{ step(it); });
+			}
+
+			// data
+			Context& S;
+			std::list<Record> tasks;
+			mutable std::mutex guard;
+			std::condition_variable wake;
+			std::deque<std::function<void()>> jobs;
+		};
+
+	}
+
+
+
+	//! @cond
+	namespace _ {
+		namespace wrap {
+
+			//! Functions returning tasks suspend the calling Lua coroutine until the task completes
+			template<typename T>
+			struct RvConvert<::lua::async::Task<T>> {
+				static Retval convert(::lua::async::Task<T>&& task, Context& c)
+				{
+					if(task.done()) {
+						if constexpr(std::is_void<T>::value) {
+							task.result();
+							return c.ret();
+						} else
+							return rvCvt<T>(task.result(), c);
+					}
+					if(!::lua::async::_::isYieldable(c)) {
+						::lua::async::_::orphan(new ::lua::async::_::Pending<T>(std::move(task)));
+						return c.error("asynchronous function called outside of a coroutine");
+					}
+					typedef ::lua::async::_::PendingOwner Owner;
+					if(c.registry[UserData<Owner>::classname].type() == ValueType::Nil)
+						c.registerUserData<Owner>();
+					std::unique_ptr<::lua::async::_::Pending<T>> pending(new ::lua::async::_::Pending<T>(std::move(task)));
+					const Retval rv = c.yieldk(::lua::async::_::finishPending<T>,
+						static_cast<LightUserData>(const_cast<char*>(&::lua::async::_::pendingMarker)),
+						c.emplace<Owner>(pending.get()));
+					pending.release();	// owned by the yielded user data
+					return rv;
+				}
+			};
+
+		}
+	}
+	//! @endcond
+
+}
+
+#endif // LUA_ASYNC_HPP_INCLUDED
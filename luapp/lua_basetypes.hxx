@@ -128,7 +128,8 @@ namespace lua {
 
 	//! @brief Return value for Lua functions.
 	//! @details This type is used for returning values from functions. You cannot create Retval directly,
-	//! only by using @ref lua::Context::ret "Context::ret" or @ref lua::Context::error "Context::error" functions.
+	//! only by using @ref lua::Context::ret "Context::ret", @ref lua::Context::fail "Context::fail", @ref lua::Context::yield "Context::yield"
+	//! or @ref lua::Context::error "Context::error" functions.
 	//! You can, however, delegate its creation to another function like this: @code{.cpp}
 	//! Retval delegated(int rv, Context& context){  // Note that this function does not conform to LFunction specification
 	//!     return context.ret(rv);
@@ -145,12 +146,18 @@ namespace lua {
 		friend int _::LFunctionWrapper(Retval(*)(Context&), lua_State*) noexcept;
 		friend int _::LFunctionUWrapper(lua_State*) noexcept;
 
-		explicit Retval(size_t amount) noexcept:
-			rvamount(amount)
+		explicit Retval(size_t amount, bool error = false, bool yield = false, Retval(*k)(Context&) = nullptr) noexcept:
+			rvamount(amount),
+			isError(error),
+			isYield(yield),
+			continuation(k)
 		{
 		}
 
 		const size_t rvamount;
+		const bool isError;	//!< Error message is on the top, raise the error after return
+		const bool isYield;	//!< Returned values are to be yielded from the coroutine
+		Retval(* const continuation)(Context&);	//!< Function called when yielded coroutine is resumed (may be null)
 	};
 
 
@@ -174,6 +181,17 @@ namespace lua {
 	typedef void* LightUserData;
 
 
+	//! @brief String with explicit length.
+	//! @details Non-owning pair of pointer and length. Strings are pushed with their length,
+	//! so no length calculation is made and embedded zeroes are preserved.
+	//! Conversion of Lua value to this type gives direct access to string stored inside Lua with no copying.
+	//! @warning After conversion from Lua value the pointer is valid only while that value remains on the stack.
+	struct StringRef {
+		const char* data;	//!< Pointer to the first character (not necessarily zero-terminated).
+		size_t size;		//!< Length of the string in bytes.
+	};
+
+
 	//! @brief Types of Lua values.
 	//! @details This enum is used to identify actual types of Lua values both in compile-time and runtime.
 	enum class ValueType {
@@ -191,6 +209,14 @@ namespace lua {
 		Any				//!< Lua value with content type indeterminable at the time of query
 	};
 
+	//! @brief Accepted kinds of chunks for loading from memory buffers.
+	//! @see lua::Context::loadBuffer
+	enum class ChunkMode {
+		Text,			//!< source text only
+		Binary,			//!< precompiled bytecode only
+		Any				//!< both source text and precompiled bytecode
+	};
+
 	//! @cond
 	template <typename UserDataType> struct UserData {};
 
@@ -203,6 +229,10 @@ namespace lua {
 	template struct UserData<double>;
 	template struct UserData<const char*>;
 	template struct UserData<std::string>;
+	template struct UserData<StringRef>;
+#ifdef LUAPP_STRING_VIEW
+	template struct UserData<std::string_view>;
+#endif	// LUAPP_STRING_VIEW
 	template struct UserData<CFunction>;
 	template struct UserData<LFunction>;
 	template struct UserData<Value>;
@@ -280,6 +310,18 @@ namespace lua {
 		static constexpr ValueType typeID = ValueType::String;
 	};
 
+	template <> struct TypeID<StringRef>
+	{
+		static constexpr ValueType typeID = ValueType::String;
+	};
+
+#ifdef LUAPP_STRING_VIEW
+	template <> struct TypeID<std::string_view>
+	{
+		static constexpr ValueType typeID = ValueType::String;
+	};
+#endif	// LUAPP_STRING_VIEW
+
 	template <> struct TypeID<CFunction>
 	{
 		static constexpr ValueType typeID = ValueType::C_Function;
@@ -365,6 +407,39 @@ namespace lua {
 
 
 
+		//! Unique per-type address, used as registry key for shared metatables
+		template<typename UDT> inline void* udCacheKey() noexcept
+		{
+			static char key;
+			return &key;
+		}
+
+
+
+		//! Metatable that matched user data type in the last check on this thread, identified by its address and
+		//! the address of the registry of its state. Valid only while the generation is current.
+		struct UDCache {
+			const void* registry;
+			const void* metatable;
+			unsigned int generation;
+		};
+
+		//! Current generation of user data caches, advanced whenever the library writes into the registry by name
+		//! (user data metatables may be replaced) and when lua::State closes its state (addresses may be reused)
+		inline std::atomic<unsigned int>& udGeneration() noexcept
+		{
+			static std::atomic<unsigned int> generation(1);
+			return generation;
+		}
+
+		template<typename UDT> inline UDCache& udCache() noexcept
+		{
+			static thread_local UDCache cache = {nullptr, nullptr, 0};
+			return cache;
+		}
+
+
+
 		//! Check whether a value can be implicitly converted to T
 		template<typename T> struct ValueConvertibleTo {
 			typedef typename std::decay<typename strip<T>::type>::type Ts;
@@ -422,6 +497,8 @@ namespace lua {
 		Context& extractContext(const Valref&) noexcept;
 		class vsIterator;
 		class vsCIterator;
+		class TableUtils;
+		class tablePairs;
 
 		template<typename, typename> class lazyConcat;
 #if(LUAPP_API_VERSION >= 52)
@@ -491,6 +568,8 @@ namespace lua {
 		friend class lua::_::uvIndexer;
 		friend class lua::_::vsIterator;
 		friend class lua::_::vsCIterator;
+		friend class lua::_::TableUtils;
+		friend class lua::_::tablePairs;
 		friend Context& lua::_::extractContext(const Valref&) noexcept;
 
 		template<typename, typename> friend class lua::_::lazyConcat;
@@ -530,16 +609,21 @@ namespace lua {
 		//! - float
 		//! - double
 		//! - const char*
+		//! - std::string
+		//! - @ref lua::StringRef "StringRef" (points to the string inside Lua, no copy is made)
+		//! - std::string_view (C++17, same as StringRef)
 		//! - @ref lua::CFunction "CFunction"
 		//! - @ref lua::LightUserData "LightUserData"
 		//! - any user data type (see @ref basic_values_user "this section"), returned by reference
+		//! @note Strings are converted with their actual length, so embedded zeroes are preserved
+		//! (except for const char* which has no length).
 		template<typename T> T cast() const;
 #else
 		template<typename T> typename std::enable_if<TypeID<T>::typeID != ValueType::UserData, T>::type cast() const;
 
 		template<typename UDT> UDT& cast(typename UserData<UDT>::enabled * = nullptr) const
 		{
-			return *static_cast<UDT*>(readUserData(UserData<UDT>::classname));
+			return *static_cast<UDT*>(readUserData(UserData<UDT>::classname, _::udCache<UDT>()));
 		}
 #endif // DOXYGEN_ONLY
 
@@ -595,10 +679,7 @@ namespace lua {
 		operator CFunction () const;		//!< @throw std::runtime_error if the value type is incompatible.
 		operator LightUserData() const;	//!< @throw std::runtime_error if the value type is incompatible.
 		operator const char* () const;	//!< @throw std::runtime_error if the value type is incompatible. @note Numbers are convertible to strings.
-		operator std::string () const	//!  @throw std::runtime_error if the value type is incompatible. @note Numbers are convertible to strings.
-		{
-			return std::string(static_cast<const char*>(*this));
-		}
+		operator std::string () const;	//!< @throw std::runtime_error if the value type is incompatible. @note Numbers are convertible to strings.
 
 #ifdef DOXYGEN_ONLY
 		//! @brief Check if the value convertible to given type.
@@ -613,6 +694,8 @@ namespace lua {
 		//! - double
 		//! - const char*
 		//! - std::string
+		//! - @ref lua::StringRef "StringRef"
+		//! - std::string_view (C++17)
 		//! - @ref lua::CFunction "CFunction" (true if the value is a C function)
 		//! - @ref lua::LFunction "LFunction" (true if the value is a function, no matter C or Lua bytecode)
 		//! - @ref lua::LightUserData "LightUserData"
@@ -630,7 +713,7 @@ namespace lua {
 
 		template<typename UDT> typename std::enable_if<TypeID<UDT>::typeID == ValueType::UserData, bool>::type is() const noexcept
 		{
-			return isUserData(UserData<UDT>::classname);
+			return isUserData(UserData<UDT>::classname, _::udCache<UDT>());
 		}
 
 #if(LUAPP_API_VERSION >= 53)
@@ -851,9 +934,9 @@ namespace lua {
 		//! Write the value from the top of the stack into Valref
 		void replace() noexcept;
 		//! Read pointer to user-data
-		void* readUserData(const char* classname) const;
-		//! Check if value is userdata of given type
-		bool isUserData(const char* classname) const noexcept;
+		void* readUserData(const char* classname, _::UDCache& cache) const;
+		//! Check if value is userdata of given type (cacheKey is registry key of last matching metatable)
+		bool isUserData(const char* classname, _::UDCache& cache) const noexcept;
 
 		//! Push all upvalues to the stack
 		void pushUpvalues() const noexcept;
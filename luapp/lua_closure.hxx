@@ -14,12 +14,30 @@ namespace lua {
 //! @cond
 	namespace _ {
 
+		namespace wrap {
+			template <size_t ...> struct PackIndices;
+		}
+
 		class lazyClosureUtils final{
 			template<typename...> friend class lazyClosure;
 		private:
 			static void makeClosure(lua_State* L, CFunction fn, size_t uvnum) noexcept;
 		};
 
+		//! Type-erased chunk reader (used by Context::load)
+		typedef StringRef (*ChunkReader)(void*);
+
+		template<typename Reader> StringRef callChunkReader(void* reader)
+		{
+			return (*static_cast<Reader*>(reader))();
+		}
+
+		class lazyReaderChunkUtils final{
+			template<typename> friend class lazyReaderChunk;
+		private:
+			static void load(lua_State* L, ChunkReader reader, void* data, const char* name, ChunkMode mode);
+		};
+
 		//! Lazy policy for closures.
 		template<typename ... UVTypes>
 		class lazyClosure final: public lazyPolicy {
@@ -113,6 +131,201 @@ namespace lua {
 			const char* const FileName;
 		};
 
+
+
+		//! Lazy policy for chunks taken from chunk cache
+		class lazyCachedChunk final: public lazyPolicy {
+			template<typename> friend class _::Lazy;
+
+		public:
+			lazyCachedChunk(lazyCachedChunk&& src) noexcept:
+				ChunkText(src.ChunkText),
+				Length(src.Length)
+			{
+			}
+
+		private:
+			lazyCachedChunk(Context&, const char* chunkText, size_t length):
+				ChunkText(chunkText),
+				Length(length)
+			{
+			}
+
+			void push(Context& S);
+
+			void pushSingle(Context& S)
+			{
+				push(S);
+			}
+
+			// data
+			const char* const ChunkText;
+			const size_t Length;
+		};
+
+
+
+		//! Lazy policy for file chunks taken from chunk cache
+		class lazyCachedFileChunk final: public lazyPolicy {
+			template<typename> friend class _::Lazy;
+
+		public:
+			lazyCachedFileChunk(lazyCachedFileChunk&& src) noexcept:
+				FileName(src.FileName)
+			{
+			}
+
+		private:
+			lazyCachedFileChunk(Context&, const char* fileName):
+				FileName(fileName)
+			{
+			}
+
+			void push(Context& S);
+			void pushSingle(Context& S)
+			{
+				push(S);
+			}
+
+			// data
+			const char* const FileName;
+		};
+
+
+
+		//! Lazy policy for chunks loaded from memory buffers
+		class lazyBufferChunk final: public lazyPolicy {
+			template<typename> friend class _::Lazy;
+
+		public:
+			lazyBufferChunk(lazyBufferChunk&& src) noexcept:
+				Data(src.Data),
+				Size(src.Size),
+				Name(src.Name),
+				Mode(src.Mode)
+			{
+			}
+
+		private:
+			lazyBufferChunk(Context&, const void* data, size_t size, const char* name, ChunkMode mode):
+				Data(static_cast<const char*>(data)),
+				Size(size),
+				Name(name),
+				Mode(mode)
+			{
+			}
+
+			void push(Context& S);
+			void pushSingle(Context& S)
+			{
+				push(S);
+			}
+
+			// data
+			const char* const Data;
+			const size_t Size;
+			const char* const Name;
+			const ChunkMode Mode;
+		};
+
+
+
+		//! Lazy policy for memory-mapped file chunks
+		class lazyMappedFileChunk final: public lazyPolicy {
+			template<typename> friend class _::Lazy;
+
+		public:
+			lazyMappedFileChunk(lazyMappedFileChunk&& src) noexcept:
+				FileName(src.FileName),
+				Mode(src.Mode)
+			{
+			}
+
+		private:
+			lazyMappedFileChunk(Context&, const char* fileName, ChunkMode mode):
+				FileName(fileName),
+				Mode(mode)
+			{
+			}
+
+			void push(Context& S);
+			void pushSingle(Context& S)
+			{
+				push(S);
+			}
+
+			// data
+			const char* const FileName;
+			const ChunkMode Mode;
+		};
+
+
+
+		//! Lazy policy for chunks read piece by piece
+		template<typename Reader>
+		class lazyReaderChunk final: public lazyPolicy {
+			template<typename> friend class _::Lazy;
+
+		public:
+			lazyReaderChunk(lazyReaderChunk<Reader>&&) noexcept = default;
+
+		private:
+			lazyReaderChunk(Context&, Reader& reader, const char* name, ChunkMode mode) noexcept:
+				ReaderPtr(&reader),
+				Name(name),
+				Mode(mode)
+			{
+			}
+
+			void push(Context& S)
+			{
+				lazyReaderChunkUtils::load(S, &callChunkReader<Reader>, const_cast<void*>(static_cast<const void*>(ReaderPtr)), Name, Mode);
+			}
+
+			void pushSingle(Context& S)
+			{
+				push(S);
+			}
+
+			// data
+			Reader* const ReaderPtr;
+			const char* const Name;
+			const ChunkMode Mode;
+		};
+
+
+
+		//! Lazy policy for user data constructed in place
+		template<typename UDT, typename ... Args>
+		class lazyEmplaceUD final: public lazyPolicy {
+			template<typename> friend class _::Lazy;
+
+		public:
+			lazyEmplaceUD(lazyEmplaceUD<UDT, Args...>&&) noexcept = default;
+
+		private:
+			lazyEmplaceUD(Context&, Args&& ... args) noexcept:
+				Arguments(std::forward<Args>(args)...)
+			{
+			}
+
+			void push(Context& S);
+
+			void pushSingle(Context& S)
+			{
+				push(S);
+			}
+
+			template<size_t ... N> void construct(Context& S, wrap::PackIndices<N...>);
+
+			//! Constructor call (true_type) or aggregate initialization (false_type)
+			static void create(void* place, std::true_type, Args&& ... args);
+			static void create(void* place, std::false_type, Args&& ... args);
+
+			// data
+			std::tuple<Args&&...> Arguments;
+		};
+
 	}
 //! @endcond
 }
@@ -19,19 +19,24 @@ namespace lua {
 
 		int LFunctionUWrapper(lua_State*) noexcept;
 
-		namespace wrap {
+		//! Type-erased user data destructor
+		typedef void (*UDDestructor)(void*);
 
-			template<typename, typename ...>
-			Retval call(Context&);
+		//! Destroy user data object in place (used by automatic "__gc" metamethod)
+		template<typename UDT> void destroyUD(void* ud) noexcept
+		{
+			static_cast<UDT*>(ud)->~UDT();
+		}
 
-			template<typename, typename, typename ...>
-			Retval memberCall(Context&);
+		//! Type-erased chunk writer (used by Context::dump)
+		typedef void (*DumpWriter)(void*, const void*, size_t);
 
-			template<typename, typename ...>
-			Retval callv(Context&);
+		template<typename Writer> void callDumpWriter(void* writer, const void* data, size_t size)
+		{
+			(*static_cast<Writer*>(writer))(data, size);
+		}
 
-			template<typename, typename, typename ...>
-			Retval memberCallv(Context&);
+		namespace wrap {
 
 			//! Envelope for wrapping member function pointers as raw userdata
 			template<typename T>
@@ -45,6 +50,25 @@ namespace lua {
 				{
 				}
 			};
+
+			//! Envelope for storing callable objects inside full userdata
+			template<typename F>
+			struct FunctorEnvelope {
+
+				F data;
+
+				template<typename S>
+				FunctorEnvelope(S&& src):
+					data(std::forward<S>(src))
+				{
+				}
+			};
+
+			template<typename, typename>
+			struct Functor;
+
+			template<typename, bool, bool = false>
+			struct ReservedCall;
 		}
 
 
@@ -52,6 +76,7 @@ namespace lua {
 	//! @endcond
 
 	class State;
+	class Coroutine;
 
 	//! @brief Access point to Lua context.
 	//! @details This object is passed to @ref lua::LFunction "compatible functions". It gives access to function's arguments,
@@ -102,12 +127,18 @@ namespace lua {
 #endif	// V53+
 		template<typename ...> friend class ::lua::_::lazyTableArray;
 		template<typename ...> friend class ::lua::_::lazyTableRecords;
+		template<typename> friend class ::lua::_::lazyTableRange;
+		friend class ::lua::_::TableUtils;
+		friend class ::lua::_::tablePairs;
+		friend class ::lua::_::tableIPairs;
+		template<typename, typename ...> friend class ::lua::_::lazyEmplaceUD;
 
 		friend class ::lua::Valset;
 		friend class ::lua::Value;
 		friend class ::lua::Table;
 
 		friend class ::lua::State;
+		friend class ::lua::Coroutine;
 
 #ifndef DOXYGEN_ONLY
 		class Registry {
@@ -264,6 +295,46 @@ namespace lua {
 			return Retval(vs.size());
 		}
 
+		//! @brief Suspend the coroutine running the function, passing values to resuming side.
+		//! @details The values passed to @ref lua::Coroutine::resume "resume" (or coroutine.resume) on the next resumption
+		//! become return values of the function. The function must be called by Lua code running in a coroutine.
+		//! Recommended use: @code{.cpp}return context.yield(values);@endcode
+		//! @note After calling this function, automatic stack management stops functioning in order to preserve yielded values.
+		//! @warning Use this function only in <code><b>return</b></code> operator!
+		template<typename ... ValueTypes>
+		Retval yield(ValueTypes&& ... values)
+		{
+			const size_t oldtop = getTop();
+#ifdef LUAPP_WATCH_STACK
+			currentStackSize = oldtop;
+#endif // LUAPP_WATCH_STACK
+			try {
+				masspush(std::forward<ValueTypes>(values)...);
+			} catch(std::exception&) {
+				pop(getTop() - oldtop);
+				throw;
+			}
+			returning = true;
+			return Retval(getTop() - oldtop, false, true);
+		}
+
+#if(LUAPP_API_VERSION >= 52)
+		//! @brief Suspend the coroutine running the function and continue with another function when it is resumed.
+		//! @details Works like @ref yield, but on the next resumption the continuation is called instead of returning:
+		//! it receives resumption values as its @ref args "arguments", and whatever it returns (or yields) is
+		//! the outcome of the original function. Local objects of the yielding function are destroyed before yielding,
+		//! so all the state needed by continuation must be kept in Lua (e.g. in upvalues or in yielded values).
+		//! Recommended use: @code{.cpp}return context.yieldk(continuation, values);@endcode
+		//! @note This function is available for Lua 5.2+.
+		//! @warning Use this function only in <code><b>return</b></code> operator!
+		template<typename ... ValueTypes>
+		Retval yieldk(LFunction continuation, ValueTypes&& ... values)
+		{
+			const Retval& rv = yield(std::forward<ValueTypes>(values)...);
+			return Retval(rv.rvamount, false, true, continuation);
+		}
+#endif	// V52+
+
 		//! @}
 
 		//! @name Error handling
@@ -282,6 +353,20 @@ namespace lua {
 		//! @details Recommended use: @code{.cpp}return context.error(); @endcode
 		//! Default message will be the result of @ref lua::Context::where "where" function.
 		Retval error();
+
+		//! @brief Report an error to Lua after the function returns.
+		//! @details Unlike @ref error, this function returns normally: the message is kept on the stack
+		//! and the error is raised by @ref lua::mkcf "function wrapper" after the function has returned
+		//! and all its local objects have been destroyed. No C++ exception is involved.
+		//! Recommended use: @code{.cpp}return context.fail(msg); @endcode
+		//! @note After calling this function, automatic stack management stops functioning in order to preserve the message.
+		//! @warning Use this function only in <code><b>return</b></code> operator!
+		Retval fail(Valobj msg);
+
+		//! @overload
+		//! @brief Report an error to Lua after the function returns.
+		//! @details Default message will be the result of @ref lua::Context::where "where" function.
+		Retval fail();
 #else	// Not DOXYGEN_ONLY
 
 		_::Lazy<_::lazyWhere> where()
@@ -300,6 +385,21 @@ namespace lua {
 			push(where());
 			return doerror();
 		}
+
+		template<typename MsgType> Retval fail(MsgType&& msg)
+		{
+#ifdef LUAPP_WATCH_STACK
+			currentStackSize = getTop();
+#endif // LUAPP_WATCH_STACK
+			ipush(std::forward<MsgType>(msg));
+			returning = true;
+			return Retval(1, true);
+		}
+
+		Retval fail()
+		{
+			return fail(where());
+		}
 #endif	// DOXYGEN_ONLY
 		//! @}
 
@@ -327,6 +427,42 @@ namespace lua {
 		//! @brief Query allocated memory amount.
 		//! @return Number of bytes allocated by Lua.
 		size_t queryMemoryTotal() const noexcept;
+
+		//! @brief Perform an incremental step of garbage collection.
+		//! @param kbytes Step size: the collector does as much work as if this amount of kilobytes was allocated.
+		//! Zero means single basic step.
+		//! @return <code><b>true</b></code> if the step finished a collection cycle.
+		bool gcStep(int kbytes = 0) noexcept;
+
+		//! @brief Perform incremental garbage collection steps until the time budget is used up.
+		//! @details Intended to be called once per frame (tick) in latency-sensitive loops, spreading collection work evenly
+		//! instead of having unpredictable full-cycle pauses. The budget may be slightly exceeded by the last step.
+		//! @param microseconds Time budget.
+		//! @return <code><b>true</b></code> if a collection cycle was finished within the budget (the stepping stops at that point).
+		bool gcStepFor(unsigned int microseconds) noexcept;
+
+		//! @brief Set garbage collector pause.
+		//! @param percent How long the collector waits before starting a new cycle (100 means no wait, 200 means waiting for memory use to double).
+		//! @return Previous value.
+		int gcSetPause(int percent) noexcept;
+
+		//! @brief Set garbage collector step multiplier.
+		//! @param percent Speed of the collector relative to memory allocation.
+		//! @return Previous value.
+		int gcSetStepMultiplier(int percent) noexcept;
+
+#ifdef DOXYGEN_ONLY
+		//! @brief Switch garbage collector into generational mode <em>[Lua 5.2 only]</em>.
+		void gcGenerational() noexcept;
+
+		//! @brief Switch garbage collector into incremental mode <em>[Lua 5.2 only]</em>.
+		void gcIncremental() noexcept;
+#else	// Not Doxygen
+#if(LUAPP_API_VERSION == 52)
+		void gcGenerational() noexcept;
+		void gcIncremental() noexcept;
+#endif	// V52
+#endif // DOXYGEN_ONLY
 		//! @}
 
 		//! @name Function handling
@@ -345,6 +481,8 @@ namespace lua {
 		//! @brief Create a wrapped Lua-compatible function from generic C/C++ function.
 		//! @details This function will create a Lua function wrapper that converts Lua arguments into native values,
 		//! calls the C function with those arguments and converts the return value back into Lua value.
+		//! @note String arguments of @ref lua::StringRef "StringRef" or std::string_view type point directly into Lua strings
+		//! (no allocation or copying), they remain valid until the wrapped function returns.
 		//! @sa LUAPP_ARG_CONVERT
 		//! @sa LUAPP_RV_CONVERT
 		template<typename ReturnValueType, typename ... ArgTypes>
@@ -359,6 +497,28 @@ namespace lua {
 		template<typename Host, typename ReturnValueType, typename ... ArgTypes>
 		Temporary wrap(ReturnValueType (Host::*fn)(ArgTypes...)) noexcept;
 
+		//! @brief Create a wrapped Lua-compatible function from function or member function, verifying all arguments at once.
+		//! @details Works like @ref wrap, but instead of checking every argument during conversion, the argument count
+		//! and types are verified together before the call (the same way as @ref checkArgs does).
+		//! After that, numbers and user data are converted without any further checks.
+		//! If verification fails, single Lua error is raised that names the first bad argument (see @ref requireArgs).
+		//! Arguments with @ref LUAPP_ARG_CONVERT "custom conversion" are not verified in advance.
+		//! @note This mode is intended for frequently called functions with numeric or user data arguments.
+		//! @sa fastwrapcf
+		template<typename FunctionPointer>
+		Temporary fastwrap(FunctionPointer fn) noexcept;
+
+		//! @brief Create a wrapped Lua-compatible function from function object (such as lambda with captures).
+		//! @details The function object is moved into userdata that is stored in the first upvalue of the wrapper,
+		//! its destructor is called when Lua collects the wrapper. The arguments and return value are converted the same way
+		//! as for function pointers. Function object with <code>@ref lua::Retval "Retval" (@ref lua::Context "Context"&)</code>
+		//! call operator is called directly, like @ref lua::LFunction "LFunction".
+		//! @note The call operator must not be overloaded or be a template (generic lambdas are not supported).
+		//! @sa LUAPP_ARG_CONVERT
+		//! @sa LUAPP_RV_CONVERT
+		template<typename Functor>
+		Temporary wrap(Functor&& fn) noexcept;
+
 		//! @brief Create a wrapped Lua-compatible function from generic C++ function discarding the call result.
 		//! @details This function will create a Lua function wrapper that converts Lua arguments into native values,
 		//! calls the C function with those arguments, discards call result and returns nothing.
@@ -393,6 +553,84 @@ namespace lua {
 		//! @throw std::runtime_error on compilation failure (file missing or syntax errors). Exception object will contain error description.
 		//! @overload
 		Temporary load(const std::string& fileName) noexcept;
+
+		//! @brief Compile a string into a chunk or take it from the chunk cache.
+		//! @details Compiled chunks are kept in the registry, keyed by the hash of the source text, so repeated calls
+		//! with the same text compile it only once. All results for the same text are the same function object.
+		//! @pre chunkText != nullptr
+		//! @throw std::runtime_error on compilation failure (syntax errors). Exception object will contain error description.
+		//! @sa setChunkCacheLimit, clearChunkCache
+		Temporary cachedChunk(const char* chunkText) noexcept;
+
+		//! @brief Compile a string into a chunk or take it from the chunk cache.
+		//! @throw std::runtime_error on compilation failure (syntax errors). Exception object will contain error description.
+		//! @overload
+		Temporary cachedChunk(const std::string& chunkText) noexcept;
+
+		//! @brief Load a file as chunk or take it from the chunk cache.
+		//! @details Cached file chunks are keyed by file name, modification time and size: the file is loaded again if it was modified.
+		//! Modification time is taken with the best resolution the platform offers (nanoseconds on POSIX, 100 ns on Windows).
+		//! @pre fileName != nullptr
+		//! @throw std::runtime_error on compilation failure (file missing or syntax errors). Exception object will contain error description.
+		//! @sa setChunkCacheLimit, clearChunkCache
+		Temporary cachedLoad(const char* fileName) noexcept;
+
+		//! @brief Load a file as chunk or take it from the chunk cache.
+		//! @throw std::runtime_error on compilation failure (file missing or syntax errors). Exception object will contain error description.
+		//! @overload
+		Temporary cachedLoad(const std::string& fileName) noexcept;
+
+		//! @brief Load a chunk from memory buffer.
+		//! @details By default only precompiled bytecode (as produced by @ref dump) is accepted.
+		//! Bytecode is not verified by Lua, so never load binary chunks from untrusted sources.
+		//! @param data Buffer contents (not necessarily zero-terminated).
+		//! @param size Buffer size in bytes.
+		//! @param name Chunk name used in error messages and debug information.
+		//! @param mode Accepted kinds of chunks.
+		//! @pre data != nullptr, name != nullptr
+		//! @throw std::runtime_error on loading failure (syntax errors, malformed bytecode or chunk kind not allowed by mode).
+		//! Exception object will contain error description.
+		Temporary loadBuffer(const void* data, size_t size, const char* name = "=(buffer)", ChunkMode mode = ChunkMode::Binary) noexcept;
+
+		//! @brief Load a chunk from memory buffer.
+		//! @throw std::runtime_error on loading failure (syntax errors, malformed bytecode or chunk kind not allowed by mode).
+		//! Exception object will contain error description.
+		//! @overload
+		Temporary loadBuffer(const std::string& buffer, const char* name = "=(buffer)", ChunkMode mode = ChunkMode::Binary) noexcept;
+
+		//! @brief Load a file as chunk through memory mapping.
+		//! @details Unlike @ref load, the file is not read through buffered stream: it is mapped into memory
+		//! and given to Lua as a single block. This is faster for large files (e.g. generated data scripts).
+		//! Both source text and precompiled bytecode files are accepted by default.
+		//! @pre fileName != nullptr
+		//! @throw std::runtime_error on compilation failure (file missing, syntax errors or chunk kind not allowed by mode).
+		//! Exception object will contain error description.
+		Temporary loadMapped(const char* fileName, ChunkMode mode = ChunkMode::Any) noexcept;
+
+		//! @brief Load a file as chunk through memory mapping.
+		//! @throw std::runtime_error on compilation failure (file missing, syntax errors or chunk kind not allowed by mode).
+		//! Exception object will contain error description.
+		//! @overload
+		Temporary loadMapped(const std::string& fileName, ChunkMode mode = ChunkMode::Any) noexcept;
+
+		//! @brief Load a chunk piece by piece.
+		//! @details The reader is a callable object returning successive pieces of the chunk as @ref lua::StringRef "StringRef",
+		//! empty piece signals the end of the chunk. Each piece must remain valid until the next call of the reader.
+		//! This allows loading chunks from streams and archives without assembling the whole chunk in memory. Example:
+		//! @code{.cpp}
+		//! Value chunk = context.load([&stream]() -> StringRef {
+		//!     const size_t got = stream.read(buffer, sizeof(buffer));
+		//!     return StringRef{buffer, got};
+		//! }, "=network");
+		//! @endcode
+		//! @note The reader is referenced, not copied, so the result must be used within the same expression.
+		//! @param reader Callable object with signature <code>StringRef()</code>.
+		//! @param name Chunk name used in error messages and debug information.
+		//! @param mode Accepted kinds of chunks.
+		//! @pre name != nullptr
+		//! @throw std::runtime_error on compilation failure (syntax errors or chunk kind not allowed by mode).
+		//! Exception object will contain error description. Exceptions thrown by reader are propagated.
+		template<typename Reader> Temporary load(Reader&& reader, const char* name = "=(reader)", ChunkMode mode = ChunkMode::Any) noexcept;
 #else	// Not DOXYGEN_ONLY
 
 		template<typename ... UVTypes>
@@ -410,55 +648,68 @@ namespace lua {
 		template<typename ReturnValueType, typename ... ArgTypes>
 		_::Lazy<_::lazyClosure<_::wrap::Envelope<ReturnValueType(*)(ArgTypes...)>>> wrap(ReturnValueType (*fn)(ArgTypes...)) noexcept
 		{
-			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::call<ReturnValueType, ArgTypes...>>, fn);
+			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::ReservedCall<decltype(fn), false>::call>, fn);
 		}
 
 		template<typename Host, typename ReturnValueType, typename ... ArgTypes>
 		_::Lazy<_::lazyClosure<_::wrap::Envelope<ReturnValueType(Host::*)(ArgTypes...)>>> wrap(ReturnValueType (Host::*fn)(ArgTypes...)) noexcept
 		{
-			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::memberCall<Host, ReturnValueType, ArgTypes...>>, fn);
+			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::ReservedCall<decltype(fn), false>::call>, fn);
 		}
 
 		template<typename Host, typename ReturnValueType, typename ... ArgTypes>
 		_::Lazy<_::lazyClosure<_::wrap::Envelope<ReturnValueType(Host::*)(ArgTypes...) const>>> wrap(ReturnValueType (Host::*fn)(ArgTypes...) const) noexcept
 		{
-			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::memberCall<Host, ReturnValueType, ArgTypes...>>, fn);
+			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::ReservedCall<decltype(fn), false>::call>, fn);
+		}
+
+		template<typename FP>
+		_::Lazy<_::lazyClosure<_::wrap::Envelope<FP>>> fastwrap(FP fn, typename std::enable_if<std::is_pointer<FP>::value || std::is_member_function_pointer<FP>::value>::type* = nullptr) noexcept
+		{
+			return _::Lazy<_::lazyClosure<_::wrap::Envelope<FP>>>(*this, mkcf<_::wrap::ReservedCall<FP, true>::call>, fn);
+		}
+
+		template<typename F>
+		_::Lazy<_::lazyClosure<_::wrap::FunctorEnvelope<typename std::decay<F>::type>>> wrap(F&& fn, typename std::enable_if<std::is_class<typename std::decay<F>::type>::value>::type* = nullptr) noexcept
+		{
+			typedef typename std::decay<F>::type Ft;
+			return _::Lazy<_::lazyClosure<_::wrap::FunctorEnvelope<Ft>>>(*this, mkcf<_::wrap::Functor<Ft, decltype(&Ft::operator())>::call>, std::forward<F>(fn));
 		}
 
 		template<typename ... ArgTypes>
 		_::Lazy<_::lazyClosure<_::wrap::Envelope<void (*)(ArgTypes...)>>> wrap(void (*fn)(ArgTypes...)) noexcept
 		{
-			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::callv<void, ArgTypes...>>, fn);
+			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::ReservedCall<decltype(fn), false>::call>, fn);
 		}
 
 		template<typename Host, typename ... ArgTypes>
 		_::Lazy<_::lazyClosure<_::wrap::Envelope<void (Host::*)(ArgTypes...)>>> wrap(void (Host::*fn)(ArgTypes...)) noexcept
 		{
-			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::memberCallv<Host, void, ArgTypes...>>, fn);
+			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::ReservedCall<decltype(fn), false>::call>, fn);
 		}
 
 		template<typename Host, typename ... ArgTypes>
 		_::Lazy<_::lazyClosure<_::wrap::Envelope<void (Host::*)(ArgTypes...) const>>> wrap(void (Host::*fn)(ArgTypes...) const) noexcept
 		{
-			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::memberCallv<Host, void, ArgTypes...>>, fn);
+			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::ReservedCall<decltype(fn), false>::call>, fn);
 		}
 
 		template<typename ReturnValueType, typename ... ArgTypes>
 		_::Lazy<_::lazyClosure<_::wrap::Envelope<ReturnValueType(*)(ArgTypes...)>>> vwrap(ReturnValueType (*fn)(ArgTypes...)) noexcept
 		{
-			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::callv<ReturnValueType, ArgTypes...>>, fn);
+			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::ReservedCall<decltype(fn), false, true>::call>, fn);
 		}
 
 		template<typename Host, typename ReturnValueType, typename ... ArgTypes>
 		_::Lazy<_::lazyClosure<_::wrap::Envelope<ReturnValueType(Host::*)(ArgTypes...)>>> vwrap(ReturnValueType (Host::*fn)(ArgTypes...)) noexcept
 		{
-			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::memberCallv<Host, ReturnValueType, ArgTypes...>>, fn);
+			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::ReservedCall<decltype(fn), false, true>::call>, fn);
 		}
 
 		template<typename Host, typename ReturnValueType, typename ... ArgTypes>
 		_::Lazy<_::lazyClosure<_::wrap::Envelope<ReturnValueType(Host::*)(ArgTypes...) const>>> vwrap(ReturnValueType (Host::*fn)(ArgTypes...) const) noexcept
 		{
-			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::memberCallv<Host, ReturnValueType, ArgTypes...>>, fn);
+			return _::Lazy<_::lazyClosure<_::wrap::Envelope<decltype(fn)>>>(*this, mkcf<_::wrap::ReservedCall<decltype(fn), false, true>::call>, fn);
 		}
 
 		_::Lazy<_::lazyChunk> chunk(const char* chunkText) noexcept
@@ -481,6 +732,53 @@ namespace lua {
 			return _::Lazy<_::lazyFileChunk>(*this, fileName.c_str());
 		}
 
+		_::Lazy<_::lazyCachedChunk> cachedChunk(const char* chunkText) noexcept
+		{
+			return _::Lazy<_::lazyCachedChunk>(*this, chunkText, std::char_traits<char>::length(chunkText));
+		}
+
+		_::Lazy<_::lazyCachedChunk> cachedChunk(const std::string& chunkText) noexcept
+		{
+			return _::Lazy<_::lazyCachedChunk>(*this, chunkText.c_str(), chunkText.size());
+		}
+
+		_::Lazy<_::lazyCachedFileChunk> cachedLoad(const char* fileName) noexcept
+		{
+			return _::Lazy<_::lazyCachedFileChunk>(*this, fileName);
+		}
+
+		_::Lazy<_::lazyCachedFileChunk> cachedLoad(const std::string& fileName) noexcept
+		{
+			return _::Lazy<_::lazyCachedFileChunk>(*this, fileName.c_str());
+		}
+
+		_::Lazy<_::lazyBufferChunk> loadBuffer(const void* data, size_t size, const char* name = "=(buffer)", ChunkMode mode = ChunkMode::Binary) noexcept
+		{
+			return _::Lazy<_::lazyBufferChunk>(*this, data, size, name, mode);
+		}
+
+		_::Lazy<_::lazyBufferChunk> loadBuffer(const std::string& buffer, const char* name = "=(buffer)", ChunkMode mode = ChunkMode::Binary) noexcept
+		{
+			return _::Lazy<_::lazyBufferChunk>(*this, buffer.data(), buffer.size(), name, mode);
+		}
+
+		_::Lazy<_::lazyMappedFileChunk> loadMapped(const char* fileName, ChunkMode mode = ChunkMode::Any) noexcept
+		{
+			return _::Lazy<_::lazyMappedFileChunk>(*this, fileName, mode);
+		}
+
+		_::Lazy<_::lazyMappedFileChunk> loadMapped(const std::string& fileName, ChunkMode mode = ChunkMode::Any) noexcept
+		{
+			return _::Lazy<_::lazyMappedFileChunk>(*this, fileName.c_str(), mode);
+		}
+
+		template<typename Reader>
+		_::Lazy<_::lazyReaderChunk<typename std::remove_reference<Reader>::type>> load(Reader&& reader, const char* name = "=(reader)", ChunkMode mode = ChunkMode::Any,
+			typename std::enable_if<std::is_class<typename std::decay<Reader>::type>::value && !std::is_convertible<Reader, std::string>::value>::type* = nullptr) noexcept
+		{
+			return _::Lazy<_::lazyReaderChunk<typename std::remove_reference<Reader>::type>>(*this, reader, name, mode);
+		}
+
 #endif	// DOXYGEN_ONLY
 
 		//! @brief Run a command string.
@@ -518,9 +816,77 @@ namespace lua {
 			Value f = load(fileName);
 			f();
 		}
+
+		//! @brief Set the maximum amount of chunks kept in the chunk cache.
+		//! @details When the cache is full, the oldest chunk is dropped to make room for the new one.
+		//! Lowering the limit below the current amount of cached chunks drops the oldest chunks down to the new limit.
+		//! The default limit is 256 chunks. Zero limit disables caching: @ref cachedChunk and @ref cachedLoad
+		//! compile the chunk every time.
+		void setChunkCacheLimit(unsigned int limit) noexcept;
+
+		//! @brief Drop all chunks from the chunk cache.
+		//! @details Functions already obtained from the cache remain valid.
+		void clearChunkCache() noexcept;
+
+#ifdef DOXYGEN_ONLY
+		//! @brief Save Lua function as precompiled bytecode.
+		//! @details The bytecode is passed to the writer in several consecutive pieces as it is produced,
+		//! writer is called as <code>writer(const void* data, size_t size)</code>.
+		//! The resulting chunk can be loaded with @ref loadBuffer. Upvalues are not saved.
+		//! @param fn Lua function (C functions cannot be dumped).
+		//! @param writer Callable object receiving the bytecode.
+		//! @param strip Strip debug information @lv53 (ignored in earlier versions).
+		//! @throw std::runtime_error if fn is not a Lua function. Exceptions thrown by writer are propagated.
+		template<typename FunctionType, typename Writer> void dump(FunctionType&& fn, Writer&& writer, bool strip = false);
+
+		//! @brief Save Lua function as precompiled bytecode.
+		//! @return Buffer containing the bytecode.
+		//! @throw std::runtime_error if fn is not a Lua function.
+		//! @overload
+		template<typename FunctionType> std::string dump(FunctionType&& fn, bool strip = false);
+#else	// Not DOXYGEN_ONLY
+		template<typename FunctionType, typename Writer>
+		typename std::enable_if<!std::is_same<typename std::decay<Writer>::type, bool>::value>::type dump(FunctionType&& fn, Writer&& writer, bool strip = false)
+		{
+			typedef typename std::remove_reference<Writer>::type W;
+			ipush(std::forward<FunctionType>(fn));
+			dumpTop(&_::callDumpWriter<W>, const_cast<void*>(static_cast<const void*>(&writer)), strip);
+		}
+
+		template<typename FunctionType>
+		std::string dump(FunctionType&& fn, bool strip = false)
+		{
+			std::string rv;
+			dump(std::forward<FunctionType>(fn), [&rv](const void* data, size_t size){rv.append(static_cast<const char*>(data), size);}, strip);
+			return rv;
+		}
+#endif	// DOXYGEN_ONLY
+		//! @}
+
+
+		//! @name User data
+		//! @{
+
+#ifdef DOXYGEN_ONLY
+		//! @brief Create user data object in place.
+		//! @details The object of type UD is constructed with given arguments directly in memory block allocated by Lua,
+		//! without creating temporary C++ object to be copied or moved. This allows non-movable types to be stored in Lua.
+		//! The metatable is assigned the same way as when pushing user data object.
+		//! Aggregate types without suitable constructor are initialized with braces.
+		//! @note The arguments are forwarded by reference, so the result must be used within the same expression.
+		//! @sa LUAPP_USERDATA
+		template<typename UD, typename ... Args> Temporary emplace (Args&& ... args) noexcept;
+#else	// Not DOXYGEN_ONLY
+		template<typename UD, typename ... Args>
+		_::Lazy<_::lazyEmplaceUD<typename _::strip<UD>::type, Args...>> emplace (Args&& ... args) noexcept
+		{
+			return _::Lazy<_::lazyEmplaceUD<typename _::strip<UD>::type, Args...>>(*this, std::forward<Args>(args)...);
+		}
+#endif	// DOXYGEN_ONLY
 		//! @}
 
 
+
 		//! @name Metatables
 		//! @{
 
@@ -528,6 +894,9 @@ namespace lua {
 		//! @brief Metatable accessor for user data type.
 		//! @details Use this function to retrieve or set metatable for registered userdata. The userdata type is specified explicitly with this function.
 		//! @note This is a better alternative to using @ref lua::Context::registry "registry" with type description strings.
+		//! Type checks remember the address of matching metatable; replacing the metatable through this accessor, @ref registry
+		//! or @ref registerUserData makes them look it up again. Replacement made with Lua API directly (e.g. luaL_newmetatable)
+		//! is not noticed: objects with the previous metatable are still recognized until the next replacement by the library.
 		//! @sa LUAPP_USERDATA
 		template<typename UD> Temporary mt () noexcept;
 #else	// Not DOXYGEN_ONLY
@@ -537,6 +906,27 @@ namespace lua {
 			return registry[UserData<typename _::strip<UD>::type>::classname];
 		}
 #endif	// DOXYGEN_ONLY
+
+#ifdef DOXYGEN_ONLY
+		//! @brief Create and register new metatable for user data type.
+		//! @details The new empty metatable replaces the previous one (if any) for the objects created afterwards.
+		//! If the type is not trivially destructible, the metatable gets "__gc" metamethod that calls destructor
+		//! of the object when Lua collects it. Trivially destructible types get no finalizer.
+		//! The finalizer ignores objects with other metatables and detaches the metatable from destroyed object,
+		//! so scripts calling "__gc" directly cannot destroy an object twice or destroy an object of another type.
+		//! @return metatable accessor, same as @ref mt "mt" function.
+		//! @note Do not replace "__gc" metamethod of the returned metatable unless you destroy the objects yourself.
+		//! @sa LUAPP_USERDATA
+		template<typename UD> Temporary registerUserData () noexcept;
+#else	// Not DOXYGEN_ONLY
+		template<typename UD>
+		_::Lazy<_::lazyConstIndexer<const char*>> registerUserData () noexcept
+		{
+			typedef typename _::strip<UD>::type UDT;
+			newUDMetatable(UserData<UDT>::classname, std::is_trivially_destructible<UDT>::value ? nullptr : &_::destroyUD<UDT>);
+			return mt<UD>();
+		}
+#endif	// DOXYGEN_ONLY
 		//! @}
 
 
@@ -657,6 +1047,9 @@ namespace lua {
 		//! Pop a value from the stack.
 		void pop(size_t amount = 1) noexcept;
 
+		//! Dump the function on the top of the stack and pop it.
+		void dumpTop(_::DumpWriter writer, void* data, bool strip);
+
 		//! Single-argument push is explicitly specialized for supported types
 		//! @tparam T the type of the value, convertible to any of:
 		//! - Nil
@@ -664,6 +1057,8 @@ namespace lua {
 		//! - double (implicit conversion from any numeric type)
 		//! - const char*
 		//! - std::string
+		//! - StringRef
+		//! - std::string_view
 		//! - CFunction
 		//! - LFunction
 		//! - closure
@@ -741,11 +1136,20 @@ namespace lua {
 		void push(CFunction) noexcept;
 		void push(LightUserData) noexcept;
 
+		void push(StringRef str) noexcept;
+
 		void push(const std::string& str)  noexcept
 		{
-			push(str.c_str());
+			push(StringRef{str.data(), str.size()});
 		}
 
+#ifdef LUAPP_STRING_VIEW
+		void push(std::string_view str) noexcept
+		{
+			push(StringRef{str.data(), str.size()});
+		}
+#endif	// LUAPP_STRING_VIEW
+
 		template<size_t N> void push(const char (&str)[N]) noexcept
 		{
 			push(static_cast<const char*>(str));
@@ -811,6 +1215,15 @@ namespace lua {
 				*reinterpret_cast<T*>(allocateUD(sizeof(T))) = fptr.data;
 		}
 
+		//! Enveloped functor push (moved into userdata)
+		template<typename F>
+		void push(_::wrap::FunctorEnvelope<F>& fn)
+		{
+			new (allocateUD(sizeof(F))) F(std::move(fn.data));
+			if(!std::is_trivially_destructible<F>::value)
+				setupGcUD(_::udCacheKey<_::wrap::FunctorEnvelope<F>>(), &_::destroyUD<F>);
+		}
+
 		//! Mass-push all arguments
 		template<typename VT, typename ... OVT>
 		void masspush(VT&& v, OVT&& ... ov)
@@ -883,6 +1296,12 @@ namespace lua {
 		//! Set userdata metatable
 		void setupUD(const char* mtrefname) noexcept;
 
+		//! Create new metatable (with "__gc" calling destructor, if present) and store it in the registry
+		void newUDMetatable(const char* mtrefname, _::UDDestructor destructor) noexcept;
+
+		//! Set metatable with "__gc" calling destructor, shared by all unnamed userdata with the same key
+		void setupGcUD(void* key, _::UDDestructor destructor) noexcept;
+
 		//! break execution and raise Lua error
 		Retval doerror() const;
 
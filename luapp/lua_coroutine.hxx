@@ -0,0 +1,234 @@
+/*
+* This file is part of Lua API++ library (https://github.com/OldFisher/lua-api-pp)
+* distributed under MIT License (http://opensource.org/licenses/MIT).
+* See license.txt for details.
+* (c) 2014 OldFisher
+*/
+
+#ifndef LUA_COROUTINE_HXX_INCLUDED
+#define LUA_COROUTINE_HXX_INCLUDED
+
+
+namespace lua {
+
+	//! @cond
+	namespace _ {
+
+		//! Lazy policy for coroutine resumption
+		template<typename ... Args>
+		class lazyResume final: public lazyPolicyNondiscardable {
+
+			template<typename> friend class ::lua::_::Lazy;
+			friend class ::lua::_::lazyPolicyNondiscardable;
+			friend class ::lua::Valset;
+
+		public:
+			lazyResume(lazyResume<Args...>&&) noexcept = default;
+
+		private:
+			lazyResume(Context& S, Coroutine& co, Args&& ... args) noexcept:
+				coroutine(co),
+				arglazy(S, std::forward<Args>(args)...)
+			{
+			}
+
+			bool push(Context& S, int rvAmount = -1);
+
+			bool pushSingle(Context& S)
+			{
+				return push(S, 1);
+			}
+
+			void onDestroy(Context& S)
+			{
+				lazyPolicyNondiscardable::onDestroy(S, *this);
+			}
+
+			void moveout() noexcept
+			{
+				lazyPolicyNondiscardable::moveout();
+				arglazy.moveout();
+			}
+
+			// data
+			Coroutine& coroutine;
+			Lazy<lazySeries<Args...>> arglazy;
+		};
+
+	}
+	//! @endcond
+
+
+
+	//! @brief Lua coroutine (Lua thread) driven from C++.
+	//! @details Coroutine creates a new Lua thread running given function. The thread is anchored in the registry,
+	//! so the object is not bound to any stack slot and may be kept as long as the context it was created with is alive.
+	//! Each @ref resume call runs the function until it yields (from Lua code or from @ref lua::Context::yield "Context::yield")
+	//! or returns, and produces yielded or returned values on the stack of that context:
+	//! @code{.cpp}
+	//! Coroutine co(context.chunk("local x = ... while true do x = x + coroutine.yield(x) end"), context);
+	//! Valset first = co.resume(1);      // first[0] == 1
+	//! int second = co.resume(10);       // 11
+	//! @endcode
+	//! Any amount of coroutines may exist in a single state, so many cooperative tasks can be driven by one loop.
+	//! @note Coroutine can be neither copied nor moved (use smart pointers or node-based containers to store them).
+	class Coroutine final {
+
+		template<typename...> friend class ::lua::_::lazyResume;
+
+	public:
+		//! @brief Coroutine status.
+		enum class Status {
+			Suspended,		//!< not started yet or yielded, can be resumed
+			Running,		//!< running (possibly resuming another coroutine)
+			Finished,		//!< the function has returned
+			Failed			//!< the function has raised an error
+		};
+
+		//! @name Life cycle
+		//! @{
+
+#ifdef DOXYGEN_ONLY
+		//! @brief Create a coroutine running given function.
+		//! @details Resumption results are placed on the stack of the context.
+		Coroutine(Valobj fn, Context& context);
+#else	// Not DOXYGEN_ONLY
+		template<typename Function>
+		Coroutine(Function&& fn, Context& context);
+#endif	// DOXYGEN_ONLY
+
+		Coroutine(const Coroutine&) = delete;
+		Coroutine& operator = (const Coroutine&) = delete;
+
+		//! @brief The thread is released and may be collected afterwards.
+		~Coroutine() noexcept;
+		//! @}
+
+		//! @name Execution
+		//! @{
+
+#ifdef DOXYGEN_ONLY
+		//! @brief Resume the coroutine, passing the arguments to it.
+		//! @details On the first resumption the arguments are passed to the function, later they become
+		//! the results of the call that has yielded.\n
+		//! Converted to @ref lua::Valset "Valset", the result contains all yielded or returned values. If the coroutine
+		//! raised an error (or cannot be resumed), Valset contains error description and its @ref lua::Valset::success "success" status is false.
+		//! Used as a single value, the result is the first yielded or returned value (or error description).
+		//! @note The resumption happens even if the result is not used.
+		Temporary resume(Valobj... args);
+#else	// Not DOXYGEN_ONLY
+		template<typename ... Args>
+		_::Lazy<_::lazyResume<Args...>> resume(Args&& ... args) noexcept
+		{
+			return _::makeLazy<_::lazyResume<Args...>>(owner, *this, std::forward<Args>(args)...);
+		}
+#endif	// DOXYGEN_ONLY
+
+		//! @brief Current status.
+		Status status() const noexcept
+		{
+			return state;
+		}
+
+		//! @brief Check if the coroutine can be resumed.
+		bool isResumable() const noexcept
+		{
+			return state == Status::Suspended;
+		}
+		//! @}
+
+		//! @name Direct interaction
+		//! @{
+
+		//! @brief Context bound to the stack of the coroutine's thread.
+		//! @details Gives access to the thread's globals, registry and stack.
+		//! @warning Stack objects created with this context must be gone before the coroutine is resumed.
+		Context& context() noexcept
+		{
+			return threadContext;
+		}
+
+		//! @brief Access to raw thread pointer (for direct use with Lua API).
+		lua_State* getRawThread() const noexcept
+		{
+			return thread;
+		}
+		//! @}
+
+	private:
+		//! Create and anchor new thread
+		lua_State* newThread() noexcept;
+
+		//! Push the function to owner's stack, then create and anchor new thread (nothing is anchored if the push throws)
+		template<typename Function> lua_State* newThread(Function&& fn);
+
+		//! Move the function from the owner's stack to the thread
+		void start() noexcept;
+
+		//! Move "nargs" arguments from the top of "from" stack and resume, results (or error message) are left on "from" stack
+		bool doResume(lua_State* from, int nargs, int rvAmount) noexcept;
+
+		// data
+		Context& owner;
+		int anchor = RegistryKey::noref;
+		lua_State* const thread;
+		Status state = Status::Suspended;
+		Context threadContext;
+	};
+
+
+
+//#####################  Coroutine  ############################################
+
+	template<typename Function>
+	inline Coroutine::Coroutine(Function&& fn, Context& context):
+		owner(context),
+		thread(newThread(std::forward<Function>(fn))),
+		threadContext(thread, Context::initializeExplicitly)
+	{
+		start();
+	}
+
+
+
+	template<typename Function>
+	inline lua_State* Coroutine::newThread(Function&& fn)
+	{
+		owner.ipush(std::forward<Function>(fn));
+		return newThread();
+	}
+
+
+
+	namespace _ {
+
+//#####################  lazyResume  ###########################################
+
+		template<typename ... Args>
+		inline bool lazyResume<Args...>::push(Context& S, int rvAmount)
+		{
+			const size_t oldtop = S.getTop();
+			Pushed = true;
+			arglazy.push();
+			return coroutine.doResume(S, static_cast<int>(S.getTop() - oldtop), rvAmount);
+		}
+
+	}
+
+
+
+//#####################  Valset  ###############################################
+
+	template<typename ... Args>
+	inline Valset::Valset(_::Lazy<_::lazyResume<Args...>>&& l):
+		S(l.S),
+		Idx(S.getTop()+1),
+		Success(l.policy.push(S)),
+		Size(S.getTop() + 1 - Idx),
+		oldCurrent(S.swapVs(this))
+	{
+	}
+
+}
+
+#endif // LUA_COROUTINE_HXX_INCLUDED
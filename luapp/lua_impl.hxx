@@ -854,6 +854,43 @@ namespace lua {
 
 
 
+//#####################  lazyEmplaceUD  ########################################
+
+
+		template<typename UDT, typename ... Args>
+		inline void lazyEmplaceUD<UDT, Args...>::push(Context& S)
+		{
+			construct(S, typename wrap::CreatePackIndices<sizeof...(Args)>::type());
+		}
+
+
+
+		template<typename UDT, typename ... Args>
+		template<size_t ... N>
+		inline void lazyEmplaceUD<UDT, Args...>::construct(Context& S, wrap::PackIndices<N...>)
+		{
+			create(S.allocateUD(sizeof(UDT)), std::is_constructible<UDT, Args...>(), std::forward<Args>(std::get<N>(Arguments))...);
+			S.setupUD(UserData<UDT>::classname);
+		}
+
+
+
+		template<typename UDT, typename ... Args>
+		inline void lazyEmplaceUD<UDT, Args...>::create(void* place, std::true_type, Args&& ... args)
+		{
+			new (place) UDT(std::forward<Args>(args)...);
+		}
+
+
+
+		template<typename UDT, typename ... Args>
+		inline void lazyEmplaceUD<UDT, Args...>::create(void* place, std::false_type, Args&& ... args)
+		{
+			new (place) UDT{std::forward<Args>(args)...};
+		}
+
+
+
 //#####################  lazyConcatSelector  ###################################
 
 
@@ -1215,10 +1252,294 @@ namespace lua {
 
 
 
+		template<typename Iterator>
+		inline void lazyTableRange<Iterator>::push(Context& s)
+		{
+			const int tableNum = TableUtils::makeNew(s, static_cast<int>(TableUtils::distance(first, last)), 0);
+			try {
+				TableUtils::fill(s, tableNum, std::move(first), std::move(last));
+			} catch(...) {
+				s.pop(s.getTop() - tableNum + 1);
+				throw;
+			}
+		}
+
+
+
+		template<typename Iterator>
+		inline size_t TableUtils::fill(Context& s, int tableNum, Iterator first, Iterator last, FillNumbers)
+		{
+			double buffer[fillChunk];
+			size_t count = 0, used = 0;
+			for(; first != last; ++first) {
+				buffer[used++] = static_cast<double>(*first);
+				if(used == fillChunk) {
+					setNumbers(s, tableNum, static_cast<int>(count + 1), buffer, used);
+					count += used;
+					used = 0;
+				}
+			}
+			setNumbers(s, tableNum, static_cast<int>(count + 1), buffer, used);
+			return count + used;
+		}
+
+
+
+		template<typename Iterator>
+		inline size_t TableUtils::fill(Context& s, int tableNum, Iterator first, Iterator last, FillIntegers)
+		{
+			long long buffer[fillChunk];
+			size_t count = 0, used = 0;
+			for(; first != last; ++first) {
+				buffer[used++] = static_cast<long long>(*first);
+				if(used == fillChunk) {
+					setIntegers(s, tableNum, static_cast<int>(count + 1), buffer, used);
+					count += used;
+					used = 0;
+				}
+			}
+			setIntegers(s, tableNum, static_cast<int>(count + 1), buffer, used);
+			return count + used;
+		}
+
+
+
+		template<typename Iterator>
+		inline size_t TableUtils::fill(Context& s, int tableNum, Iterator first, Iterator last, FillStrings)
+		{
+			StringRef buffer[fillChunk];
+			size_t count = 0, used = 0;
+			for(; first != last; ++first) {
+				buffer[used++] = toStringRef(*first);
+				if(used == fillChunk) {
+					setStrings(s, tableNum, static_cast<int>(count + 1), buffer, used);
+					count += used;
+					used = 0;
+				}
+			}
+			setStrings(s, tableNum, static_cast<int>(count + 1), buffer, used);
+			return count + used;
+		}
+
+
+
+		template<typename Iterator>
+		inline size_t TableUtils::fill(Context& s, int tableNum, Iterator first, Iterator last, FillUserData)
+		{
+			typedef typename FillKind<Iterator>::element UDT;
+			const int mtNum = pushUDMetatable(s, UserData<UDT>::classname);
+			size_t count = 0;
+			try {
+				for(; first != last; ++first) {
+					new (newUD(s, sizeof(UDT))) UDT(*first);
+					setUD(s, tableNum, mtNum, static_cast<int>(++count));
+				}
+			} catch(...) {
+				s.pop(s.getTop() - mtNum + 1);
+				throw;
+			}
+			s.pop();
+			return count;
+		}
+
+
+
+		template<typename Iterator>
+		inline size_t TableUtils::fill(Context& s, int tableNum, Iterator first, Iterator last, FillGeneric)
+		{
+			size_t count = 0;
+			for(; first != last; ++first) {
+				s.ipush(*first);
+				setValue(s, tableNum, static_cast<int>(++count));
+			}
+			return count;
+		}
+
+	}
+
+
+
+	template<typename InputIterator>
+	inline Table& Table::assign(InputIterator first, InputIterator last)
+	{
+		const size_t count = _::TableUtils::fill(Anchor.context, Anchor.index, std::move(first), std::move(last));
+		_::TableUtils::clearFrom(Anchor.context, Anchor.index, static_cast<int>(count + 1));
+		return *this;
+	}
+
+
+
+
+	namespace _ {
+
+		template<typename T, typename OutputIterator>
+		inline OutputIterator TableUtils::read(Context& s, int tableNum, OutputIterator out, ReadNumbers)
+		{
+			const size_t len = length(s, tableNum);
+			double buffer[fillChunk];
+			size_t failures = 0;
+			long long firstFailure = 0;
+			for(size_t key = 1; key <= len;) {
+				const size_t wanted = len - key + 1 < fillChunk ? len - key + 1 : fillChunk;
+				const size_t got = getNumbers(s, tableNum, static_cast<int>(key), buffer, wanted);
+				for(size_t i = 0; i < got; ++i, ++out)
+					*out = static_cast<T>(buffer[i]);
+				key += got;
+				if(got < wanted) {
+					if(!failures++)
+						firstFailure = static_cast<long long>(key);
+					++key;
+				}
+			}
+			if(failures)
+				conversionError(failures, firstFailure);
+			return out;
+		}
+
+
+
+		template<typename T, typename OutputIterator>
+		inline OutputIterator TableUtils::read(Context& s, int tableNum, OutputIterator out, ReadGeneric)
+		{
+			const size_t len = length(s, tableNum);
+			const int slot = static_cast<int>(s.getTop()) + 1;
+			size_t failures = 0;
+			long long firstFailure = 0;
+			for(size_t key = 1; key <= len; ++key) {
+				getValue(s, tableNum, static_cast<int>(key));
+				const Valref v(s, slot);
+				if(v.is<T>()) {
+					*out = v.cast<T>();
+					++out;
+				} else if(!failures++)
+					firstFailure = static_cast<long long>(key);
+				s.pop();
+			}
+			if(failures)
+				conversionError(failures, firstFailure);
+			return out;
+		}
+
 	}
 
 
 
+	template<typename T, typename OutputIterator>
+	inline OutputIterator Table::copyTo(OutputIterator out) const
+	{
+		return _::TableUtils::read<T>(Anchor.context, Anchor.index, std::move(out), typename _::TableUtils::ReadKind<T>::type());
+	}
+
+
+
+	template<typename T>
+	inline std::vector<T> Table::toVector() const
+	{
+		std::vector<T> result;
+		result.reserve(_::TableUtils::length(Anchor.context, Anchor.index));
+		copyTo<T>(std::back_inserter(result));
+		return result;
+	}
+
+
+
+	template<typename Map>
+	inline Map Table::toMap() const
+	{
+		typedef typename Map::key_type K;
+		typedef typename Map::mapped_type V;
+		Map result;
+		size_t failures = 0;
+		iterate([&](const Valref& key, const Valref& value) {
+			if(_::TableUtils::keyFits<K>(key) && value.is<V>())
+				result.emplace(key.cast<K>(), value.cast<V>());
+			else
+				++failures;
+		});
+		if(failures)
+			_::TableUtils::conversionError(failures, 0);
+		return result;
+	}
+
+
+
+	inline _::tablePairs Table::pairs() const noexcept
+	{
+		return _::tablePairs(Anchor.context, Anchor.index);
+	}
+
+
+
+	inline _::tableIPairs Table::ipairs() const noexcept
+	{
+		return _::tableIPairs(Anchor.context, Anchor.index, Valref(Anchor.context, static_cast<int>(Anchor.context.getTop()) + 1));
+	}
+
+
+
+	namespace _ {
+
+		inline tablePairs::~tablePairs() noexcept
+		{
+			if(active)
+				context.pop(2);
+		}
+
+
+
+		inline tablePairs::iterator tablePairs::begin()
+		{
+			if(!started) {
+				started = true;
+				const int top = static_cast<int>(context.getTop());
+				new(&entry) Entry{Valref(context, top + 1), Valref(context, top + 2)};
+				Table::beginIteration(context);
+				advance();
+			}
+			return iterator(this);
+		}
+
+
+
+		inline void tablePairs::advance()
+		{
+			active = TableUtils::nextPair(context, tableNum);
+		}
+
+
+
+		inline tableIPairs::~tableIPairs() noexcept
+		{
+			if(loaded)
+				context.pop();
+		}
+
+
+
+		inline tableIPairs::iterator tableIPairs::begin() noexcept
+		{
+			if(!started) {
+				started = true;
+				length = TableUtils::length(context, tableNum);
+				advance();
+			}
+			return iterator(this);
+		}
+
+
+
+		inline void tableIPairs::advance() noexcept
+		{
+			if(loaded)
+				context.pop();
+			loaded = ++entry.index <= length;
+			if(loaded)
+				TableUtils::getValue(context, tableNum, static_cast<int>(entry.index));
+		}
+
+	}
+
+
 
 	template<typename IterationFunction>
 	inline typename std::enable_if<
@@ -1484,7 +1805,7 @@ namespace lua {
 	{
 		const auto nArgsExpected = std::max(sizeof ... (ArgTypes), amount);
 		if(args.size() < nArgsExpected)
-			error(where() & " Insufficient number of arguments (" &  nArgsExpected & " expected, " & args.size() & " passed).");
+			error(where() & " Insufficient number of arguments (" &  static_cast<unsigned int>(nArgsExpected) & " expected, " & static_cast<unsigned int>(args.size()) & " passed).");
 		requireArg<ArgTypes..., void>(0);
 	}
 
@@ -1495,7 +1816,7 @@ namespace lua {
 		if(args[idx].is<typename std::conditional<std::is_void<T>::value, Value, T>::type>())
 			requireArg<OtherArgTypes...>(idx + 1);
 		else
-			error(where() & " Argument " & (idx + 1) & " type is incompatible.");
+			error(where() & " Argument " & static_cast<unsigned int>(idx + 1) & " type is incompatible.");
 	}
 
 
@@ -34,6 +34,9 @@ namespace lua{
 		template<typename, typename...> class lazyCall;
 		template<typename, typename...> class lazyPCall;
 		template<typename...> class lazyClosure;
+		template<typename, typename...> class lazyEmplaceUD;
+		template<typename> class lazyReaderChunk;
+		template<typename...> class lazyResume;
 #if(LUAPP_API_VERSION >= 52)
 		template<typename> class lazyLenTemp;
 #endif	// V52+
@@ -80,6 +83,7 @@ namespace lua{
 			template<typename, typename ...> friend class ::lua::_::lazyCall;
 			template<typename, typename ...> friend class ::lua::_::lazyPCall;
 			template<typename...> friend class ::lua::_::lazyClosure;
+			template<typename...> friend class ::lua::_::lazyResume;
 			template<typename P, typename ... Args> friend Lazy<P> makeLazy(Args&& ...) noexcept;
 
 			// Operations
@@ -0,0 +1,209 @@
+/*
+* This file is part of Lua API++ library (https://github.com/OldFisher/lua-api-pp)
+* distributed under MIT License (http://opensource.org/licenses/MIT).
+* See license.txt for details.
+* (c) 2014 OldFisher
+*/
+
+#ifndef LUA_POOL_HPP_INCLUDED
+#define LUA_POOL_HPP_INCLUDED
+
+#include "lua.hpp"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+
+//! @file
+//! @brief Pool of reusable Lua states (optional, include separately).
+
+namespace lua {
+
+	//! @brief Thread-safe pool of pre-initialized Lua states.
+	//! @details Creating and initializing a state (opening libraries, loading modules) is moved off the request path:
+	//! states are created by the pool, prepared by user-supplied initializer and handed out with @ref acquire.
+	//! When a state is returned, its globals are @ref lua::State::restoreGlobals "restored" to the snapshot
+	//! taken right after initialization. States using more memory than the limit (after garbage collection) are dropped.
+	//! @code{.cpp}
+	//! StatePool pool([](State& s){ s.runFile("prelude.lua"); }, 8);
+	//! ...
+	//! {
+	//!     StatePool::Lease lease = pool.acquire();
+	//!     lease->runString(request);
+	//! }   // the state goes back to the pool here
+	//! @endcode
+	//! @note A state is used by one thread at a time, but different leases may be used by different threads.
+	//! The pool must outlive all its leases.
+	//! @warning Restoring is not a sandbox reset. A returned state keeps everything @ref lua::State::restoreGlobals
+	//! does not cover: registry entries (including references and user data metatables), fields added to or removed from
+	//! library tables and other tables reachable from globals, upvalues, metatables of other types set with debug.setmetatable,
+	//! hooks set on coroutines and any state kept by C modules. Do not share a pool between mutually untrusted scripts.
+	class StatePool {
+	public:
+		//! @brief State initializer.
+		typedef std::function<void(State&)> Initializer;
+
+		//! @brief Exclusive access to pooled state. The state is returned to the pool on destruction.
+		class Lease {
+			friend class StatePool;
+		public:
+			//! @brief Empty lease.
+			Lease() noexcept = default;
+
+			Lease(Lease&& src) noexcept:
+				pool(src.pool),
+				state(std::move(src.state))
+			{
+				src.pool = nullptr;
+			}
+
+			Lease& operator = (Lease&& src) noexcept
+			{
+				if(this != &src) {
+					release();
+					pool = src.pool;
+					state = std::move(src.state);
+					src.pool = nullptr;
+				}
+				return *this;
+			}
+
+			~Lease() noexcept
+			{
+				release();
+			}
+
+			//! @brief Check if the lease holds a state.
+			explicit operator bool() const noexcept
+			{
+				return static_cast<bool>(state);
+			}
+
+			State& operator * () const noexcept
+			{
+				return *state;
+			}
+
+			State* operator -> () const noexcept
+			{
+				return state.get();
+			}
+
+			//! @brief Destroy the state instead of returning it to the pool (e.g. when its integrity is doubtful).
+			void drop() noexcept
+			{
+				state.reset();
+				pool = nullptr;
+			}
+
+			//! @brief Return the state to the pool before the lease is destroyed.
+			void release() noexcept
+			{
+				if(pool && state)
+					pool->put(std::move(state));
+				state.reset();
+				pool = nullptr;
+			}
+
+		private:
+			Lease(StatePool* owner, std::unique_ptr<State>&& s) noexcept:
+				pool(owner),
+				state(std::move(s))
+			{
+			}
+
+			StatePool* pool = nullptr;
+			std::unique_ptr<State> state;
+		};
+
+		//! @param init Initializer called once for every new state (may be empty).
+		//! @param prewarm Amount of states created in constructor.
+		//! @param maxIdle Maximum amount of idle states kept by the pool, extra returned states are destroyed.
+		//! @param memoryLimit States using more memory (in bytes) on return are destroyed. Zero means no limit.
+		//! @param libraries Standard libraries opened in new states (combination of @ref lua::lib::Library "library flags").
+		//! @throw std::runtime_error if a state cannot be created; exceptions thrown by initializer are propagated.
+		explicit StatePool(Initializer init = Initializer(), size_t prewarm = 0, size_t maxIdle = 16, size_t memoryLimit = 0, lib::Library libraries = lib::all):
+			initializer(std::move(init)),
+			maxIdle(maxIdle),
+			memoryLimit(memoryLimit),
+			libraries(libraries)
+		{
+			idle.reserve(std::max(prewarm, maxIdle));
+			for(size_t i = 0; i < prewarm; ++i)
+				idle.push_back(create());
+		}
+
+		StatePool(const StatePool&) = delete;
+		StatePool& operator = (const StatePool&) = delete;
+
+		//! @brief Take a state from the pool, creating a new one if there are no idle states.
+		//! @throw std::runtime_error if a state cannot be created; exceptions thrown by initializer are propagated.
+		Lease acquire()
+		{
+			{
+				std::lock_guard<std::mutex> lock(guard);
+				if(!idle.empty()) {
+					std::unique_ptr<State> s = std::move(idle.back());
+					idle.pop_back();
+					return Lease(this, std::move(s));
+				}
+			}
+			return Lease(this, create());
+		}
+
+		//! @brief Amount of idle states.
+		size_t idleCount() const
+		{
+			std::lock_guard<std::mutex> lock(guard);
+			return idle.size();
+		}
+
+	private:
+		std::unique_ptr<State> create()
+		{
+			std::unique_ptr<State> s(new State(libraries));
+			if(initializer)
+				initializer(*s);
+			s->saveGlobals();
+			return s;
+		}
+
+		void put(std::unique_ptr<State>&& s) noexcept
+		{
+			try {
+				s->restoreGlobals();
+				if(memoryLimit) {
+					Context context(s->getRawState(), Context::initializeExplicitly);
+					if(context.queryMemoryTotal() > memoryLimit) {
+						context.gcCollect();
+						if(context.queryMemoryTotal() > memoryLimit)
+							return;
+					}
+				}
+			} catch(...) {
+				return;
+			}
+			std::unique_ptr<State> extra;	// destroyed outside the lock
+			{
+				std::lock_guard<std::mutex> lock(guard);
+				if(idle.size() < maxIdle)
+					idle.push_back(std::move(s));
+				else
+					extra = std::move(s);
+			}
+		}
+
+		// data
+		const Initializer initializer;
+		const size_t maxIdle;
+		const size_t memoryLimit;
+		const lib::Library libraries;
+		mutable std::mutex guard;
+		std::vector<std::unique_ptr<State>> idle;
+	};
+
+}
+
+#endif // LUA_POOL_HPP_INCLUDED
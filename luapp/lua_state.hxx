@@ -12,6 +12,34 @@
 
 namespace lua {
 
+	//! @brief Standard Lua libraries.
+	namespace lib {
+		//! @brief Library flags for @ref lua::State::State(lib::Library) "State" constructor, combine them with "|" operator.
+		enum Library: unsigned int {
+			none = 0,			//!< no libraries
+			base = 1 << 0,		//!< basic functions (in Lua 5.1 it includes coroutine library)
+			package = 1 << 1,	//!< modules (require)
+			coroutine = 1 << 2,	//!< coroutines @lv52
+			string = 1 << 3,	//!< string manipulation
+			table = 1 << 4,		//!< table manipulation
+			math = 1 << 5,		//!< mathematical functions
+			io = 1 << 6,		//!< input and output
+			os = 1 << 7,		//!< operating system facilities
+			debug = 1 << 8,		//!< debug facilities
+			bit32 = 1 << 9,		//!< bitwise operations <em>[Lua 5.2 only]</em>
+			utf8 = 1 << 10,		//!< UTF-8 support @lv53
+			all = ~0u			//!< all libraries (opened with luaL_openlibs)
+		};
+
+		//! @brief Combination of library flags.
+		constexpr Library operator | (Library lhs, Library rhs) noexcept
+		{
+			return static_cast<Library>(static_cast<unsigned int>(lhs) | static_cast<unsigned int>(rhs));
+		}
+	}
+
+
+
 	//! @brief Lua state object.
 	//! @details State object represents a Lua state. Besides state creation and destruction,
 	//! it can be used for setting up the environment by executing Lua files,
@@ -29,6 +57,20 @@ namespace lua {
 		//! @brief Custom allocator constructor.
 		explicit State(void* (__cdecl customAllocatorFunction) (void* ud, void* ptr, size_t oldSize, size_t newSize), void* ud = nullptr);
 
+		//! @brief Selected libraries constructor.
+		//! @details Only the libraries specified are opened, which makes state creation faster and the state smaller.
+		//! Libraries not available in current Lua version are ignored.
+		//! @param libraries Combination of @ref lua::lib::Library "library flags", e.g. <code>lib::base | lib::string | lib::table</code>.
+		explicit State(lib::Library libraries);
+
+		//! @brief Bare integers are not accepted as library flags (0 would select custom allocator constructor), use @ref lua::lib::none "lib::none".
+		template<typename Integer, typename = typename std::enable_if<std::is_integral<Integer>::value>::type>
+		explicit State(Integer) = delete;
+
+		//! @brief Custom allocator and selected libraries constructor.
+		//! @param libraries Combination of @ref lua::lib::Library "library flags".
+		State(void* (__cdecl customAllocatorFunction) (void* ud, void* ptr, size_t oldSize, size_t newSize), void* ud, lib::Library libraries);
+
 		//! @brief Destructor frees the associated Lua state.
 		//! @details All raw pointers to lua_State are invalidated after object destruction.
 		~State() noexcept;
@@ -69,10 +111,38 @@ namespace lua {
 			return runString(expression.c_str());
 		}
 
+		//! @brief Execute precompiled bytecode.
+		//! @details Source text is rejected, so only chunks produced by @ref lua::Context::dump "dump" (or luac) can be executed.
+		//! @pre data != nullptr, name != nullptr
+		//! @throw std::runtime_error In case of loading or execution error, what() contains additional information.
+		void runBytecode(const void* data, size_t size, const char* name = "=(bytecode)");
+
+		//! @brief Execute precompiled bytecode.
+		//! @throw std::runtime_error In case of loading or execution error, what() contains additional information.
+		//! @overload
+		void runBytecode(const std::string& bytecode, const char* name = "=(bytecode)")
+		{
+			runBytecode(bytecode.data(), bytecode.size(), name);
+		}
+
 		//! @brief Execute C function.
 		//! @pre f != nullptr
 		//! @throw std::runtime_error In case of execution error, what() contains additional information.
 		void call(CFunction f);
+
+		//! @brief Remember current contents of global table and loaded modules table (package.loaded).
+		//! @details Metatable of the global table, the string metatable and debug hook of the main thread are saved too.
+		//! The snapshot is shallow: it holds references to global values, not their copies.
+		//! @throw std::runtime_error In case of memory error.
+		//! @see restoreGlobals
+		void saveGlobals();
+
+		//! @brief Restore global table and loaded modules table to the state saved by @ref saveGlobals.
+		//! @details Globals created after the snapshot are removed, changed and removed ones get their saved values back.
+		//! Metatable of the global table, the string metatable (with its fields) and main thread's hook are restored as well.
+		//! Changes made inside other tables (e.g. new fields in library tables) are not reverted. The stack is cleared too.
+		//! @throw std::runtime_error if no snapshot was made or in case of memory error.
+		void restoreGlobals();
 		//! @}
 
 		//! @name Direct Lua API interaction
@@ -98,16 +98,393 @@ namespace lua {
 		};
 
 
+		class tablePairs;
+		class tableIPairs;
+
+		//! Table creator policy for native ranges
+		template<typename Iterator>
+		class lazyTableRange: public _::lazyPolicy {
+
+			template<typename> friend class ::lua::_::Lazy;
+
+		public:
+			lazyTableRange(lazyTableRange<Iterator>&&) noexcept = default;
+
+		private:
+			lazyTableRange(Context&, Iterator first_, Iterator last_):
+				first(std::move(first_)),
+				last(std::move(last_))
+			{
+			}
+
+			void push(Context& s);
+
+			void pushSingle(Context& s)
+			{
+				push(s);
+			}
+
+			void onDestroy(Context&)
+			{
+			}
+
+			void moveout() noexcept
+			{
+			}
+
+			Iterator first, last;
+		};
+
+
 		class TableUtils {
 		private:
 			template<typename...> friend class ::lua::_::lazyTableArray;
 			template<typename...> friend class ::lua::_::lazyTableRecords;
+			template<typename> friend class ::lua::_::lazyTableRange;
+			friend class ::lua::_::tablePairs;
+			friend class ::lua::_::tableIPairs;
 			friend class ::lua::Table;
 
 			static int makeNew(lua_State* s, int arrSize, int recSize) noexcept;
 
 			static void setValue(lua_State* s, int tableNum, int key) noexcept;
 			static void setValue(lua_State* s, int tableNum) noexcept;
+
+			// Batch writers: values are stored under consecutive keys starting with firstKey
+			static void setNumbers(lua_State* s, int tableNum, int firstKey, const double* values, size_t count) noexcept;
+			static void setIntegers(lua_State* s, int tableNum, int firstKey, const long long* values, size_t count) noexcept;
+			static void setStrings(lua_State* s, int tableNum, int firstKey, const StringRef* values, size_t count) noexcept;
+
+			// User data writers: the metatable is looked up once and kept on the stack
+			static int pushUDMetatable(lua_State* s, const char* classname) noexcept;
+			static void* newUD(lua_State* s, size_t size) noexcept;
+			static void setUD(lua_State* s, int tableNum, int mtNum, int key) noexcept;
+
+			//! Remove the sequence of values starting with firstKey
+			static void clearFrom(lua_State* s, int tableNum, int firstKey) noexcept;
+
+			// Element categories for range filling
+			struct FillNumbers {};
+			struct FillIntegers {};
+			struct FillStrings {};
+			struct FillUserData {};
+			struct FillGeneric {};
+
+			template<typename Iterator>
+			struct FillKind {
+				typedef decltype(*std::declval<Iterator&>()) reference;
+				typedef typename std::remove_cv<typename std::remove_reference<reference>::type>::type element;
+				static constexpr bool forward = std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value;
+				typedef typename std::conditional<std::is_arithmetic<element>::value && !std::is_same<element, bool>::value,
+#if(LUAPP_API_VERSION >= 53)
+					typename std::conditional<std::is_integral<element>::value, FillIntegers, FillNumbers>::type,
+#else	// V52-
+					FillNumbers,
+#endif	// V53+
+					// strings are buffered before pushing, so they must stay valid after incrementing the iterator
+					typename std::conditional<::lua::TypeID<element>::typeID == ValueType::String && forward
+						&& (std::is_lvalue_reference<reference>::value || !std::is_same<element, std::string>::value),
+						FillStrings,
+						typename std::conditional<::lua::TypeID<element>::typeID == ValueType::UserData, FillUserData, FillGeneric>::type
+					>::type
+				>::type type;
+			};
+
+			static StringRef toStringRef(const std::string& str) noexcept
+			{
+				return StringRef{str.data(), str.size()};
+			}
+
+			static StringRef toStringRef(const char* str) noexcept
+			{
+				return StringRef{str, std::char_traits<char>::length(str)};
+			}
+
+			static StringRef toStringRef(StringRef str) noexcept
+			{
+				return str;
+			}
+
+#ifdef LUAPP_STRING_VIEW
+			static StringRef toStringRef(std::string_view str) noexcept
+			{
+				return StringRef{str.data(), str.size()};
+			}
+#endif	// LUAPP_STRING_VIEW
+
+			//! Amount of elements if it can be known in advance (0 otherwise)
+			template<typename Iterator>
+			static size_t distance(const Iterator& first, const Iterator& last)
+			{
+				return std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value ?
+					static_cast<size_t>(std::distance(first, last)) : 0;
+			}
+
+			//! Store values from the range under keys 1..n, return n
+			template<typename Iterator>
+			static size_t fill(Context& s, int tableNum, Iterator first, Iterator last)
+			{
+				return fill(s, tableNum, std::move(first), std::move(last), typename FillKind<Iterator>::type());
+			}
+
+			template<typename Iterator> static size_t fill(Context& s, int tableNum, Iterator first, Iterator last, FillNumbers);
+			template<typename Iterator> static size_t fill(Context& s, int tableNum, Iterator first, Iterator last, FillIntegers);
+			template<typename Iterator> static size_t fill(Context& s, int tableNum, Iterator first, Iterator last, FillStrings);
+			template<typename Iterator> static size_t fill(Context& s, int tableNum, Iterator first, Iterator last, FillUserData);
+			template<typename Iterator> static size_t fill(Context& s, int tableNum, Iterator first, Iterator last, FillGeneric);
+
+			//! Size of intermediate buffers used by batch writers and readers
+			static constexpr const size_t fillChunk = 64;
+
+			//! Raw length of the table
+			static size_t length(lua_State* s, int tableNum) noexcept;
+
+			//! Read numbers stored under consecutive keys, stop at the first non-number and return the amount of numbers read
+			static size_t getNumbers(lua_State* s, int tableNum, int firstKey, double* values, size_t count) noexcept;
+
+			//! Push raw table element
+			static void getValue(lua_State* s, int tableNum, int key) noexcept;
+
+			//! Replace the value of previous pair with the next key and value (lua_next), return false at the end
+			static bool nextPair(lua_State* s, int tableNum);
+
+			//! Report elements that could not be converted (key is 0 if unknown)
+			static void conversionError(size_t failures, long long firstKey);
+
+			// Element categories for range extraction
+			struct ReadNumbers {};
+			struct ReadGeneric {};
+
+			template<typename T>
+			struct ReadKind {
+				typedef typename std::conditional<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, ReadNumbers, ReadGeneric>::type type;
+			};
+
+			//! Store converted array elements to output iterator
+			template<typename T, typename OutputIterator> static OutputIterator read(Context& s, int tableNum, OutputIterator out, ReadNumbers);
+			template<typename T, typename OutputIterator> static OutputIterator read(Context& s, int tableNum, OutputIterator out, ReadGeneric);
+
+			//! Check if a key may be converted without disturbing the traversal (lua_tolstring changes numbers in place)
+			template<typename T>
+			static bool keyFits(const Valref& key) noexcept
+			{
+				return ::lua::TypeID<T>::typeID == ValueType::String ? key.type() == ValueType::String : key.is<T>();
+			}
+		};
+
+
+
+		//! Range of all key-value pairs of a table (lua_next traversal).
+		//! Current key and value occupy two stack slots while the traversal is active.
+		//! The table is referred to by its stack index, so the Table object must outlive the loop.
+		class tablePairs {
+			friend class ::lua::Table;
+
+		public:
+			//! Key-value pair (references to stack slots, valid until the next step)
+			struct Entry {
+				Valref key;
+				Valref value;
+			};
+
+			class iterator {
+				friend class tablePairs;
+
+			public:
+				typedef std::input_iterator_tag iterator_category;
+				typedef Entry value_type;
+				typedef std::ptrdiff_t difference_type;
+				typedef const Entry* pointer;
+				typedef const Entry& reference;
+
+				const Entry& operator * () const noexcept
+				{
+					return owner->entry;
+				}
+
+				const Entry* operator -> () const noexcept
+				{
+					return &owner->entry;
+				}
+
+				iterator& operator ++ ()
+				{
+					owner->advance();
+					return *this;
+				}
+
+				bool operator == (const iterator& rhs) const noexcept
+				{
+					return finished() == rhs.finished();
+				}
+
+				bool operator != (const iterator& rhs) const noexcept
+				{
+					return finished() != rhs.finished();
+				}
+
+			private:
+				explicit iterator(tablePairs* view) noexcept:
+					owner(view)
+				{
+				}
+
+				bool finished() const noexcept
+				{
+					return !owner || !owner->active;
+				}
+
+				tablePairs* owner;
+			};
+
+			tablePairs(tablePairs&& src) noexcept:
+				context(src.context),
+				tableNum(src.tableNum),
+				active(src.active),
+				started(src.started)
+			{
+				if(started)
+					new(&entry) Entry(src.entry);
+				src.active = false;
+			}
+
+			tablePairs& operator = (const tablePairs&) = delete;
+
+			//! Stops unfinished traversal (e.g. after "break")
+			~tablePairs() noexcept;
+
+			//! Start the traversal (only once)
+			iterator begin();
+
+			iterator end() noexcept
+			{
+				return iterator(nullptr);
+			}
+
+		private:
+			tablePairs(Context& s, int t) noexcept:
+				context(s),
+				tableNum(t)
+			{
+			}
+
+			void advance();
+
+			// data
+			Context& context;
+			const int tableNum;
+			union {
+				Entry entry;	// slots are known only when the traversal starts
+			};
+			bool active = false;
+			bool started = false;
+		};
+
+
+
+		//! Range of array elements 1..n of a table (n being raw length), read with lua_rawgeti.
+		//! Current value occupies a stack slot while the traversal is active.
+		class tableIPairs {
+			friend class ::lua::Table;
+
+		public:
+			//! Index and value (reference to stack slot, valid until the next step)
+			struct Entry {
+				size_t index;
+				Valref value;
+			};
+
+			class iterator {
+				friend class tableIPairs;
+
+			public:
+				typedef std::input_iterator_tag iterator_category;
+				typedef Entry value_type;
+				typedef std::ptrdiff_t difference_type;
+				typedef const Entry* pointer;
+				typedef const Entry& reference;
+
+				const Entry& operator * () const noexcept
+				{
+					return owner->entry;
+				}
+
+				const Entry* operator -> () const noexcept
+				{
+					return &owner->entry;
+				}
+
+				iterator& operator ++ () noexcept
+				{
+					owner->advance();
+					return *this;
+				}
+
+				bool operator == (const iterator& rhs) const noexcept
+				{
+					return finished() == rhs.finished();
+				}
+
+				bool operator != (const iterator& rhs) const noexcept
+				{
+					return finished() != rhs.finished();
+				}
+
+			private:
+				explicit iterator(tableIPairs* view) noexcept:
+					owner(view)
+				{
+				}
+
+				bool finished() const noexcept
+				{
+					return !owner || !owner->loaded;
+				}
+
+				tableIPairs* owner;
+			};
+
+			tableIPairs(tableIPairs&& src) noexcept:
+				context(src.context),
+				tableNum(src.tableNum),
+				entry(src.entry),
+				length(src.length),
+				loaded(src.loaded),
+				started(src.started)
+			{
+				src.loaded = false;
+			}
+
+			tableIPairs& operator = (const tableIPairs&) = delete;
+
+			//! Releases the slot of current value (e.g. after "break")
+			~tableIPairs() noexcept;
+
+			//! Start the traversal (only once)
+			iterator begin() noexcept;
+
+			iterator end() noexcept
+			{
+				return iterator(nullptr);
+			}
+
+		private:
+			tableIPairs(Context& s, int t, Valref slot) noexcept:
+				context(s),
+				tableNum(t),
+				entry{0, slot}
+			{
+			}
+
+			void advance() noexcept;
+
+			// data
+			Context& context;
+			const int tableNum;
+			Entry entry;
+			size_t length = 0;
+			bool loaded = false;
+			bool started = false;
 		};
 	}
 	//! @endcond
@@ -340,6 +717,89 @@ namespace lua {
 #endif	// DOXYGEN_ONLY
 		//! @}
 
+		//! @name Bulk operations
+		//! @{
+
+		//! @brief Replace array elements with the contents of a native range.
+		//! @details Values are stored under keys 1..n with raw writes (metatable is ignored), then the elements
+		//! that followed the old sequence after n are removed. Numbers and strings are written in batches,
+		//! user data metatable is looked up only once.
+		//! @tparam InputIterator Iterator over values of any type that can be pushed.
+		//! @note If an exception is thrown (e.g. by user data copy constructor), the table is left partially filled.
+		template<typename InputIterator>
+		Table& assign(InputIterator first, InputIterator last);
+
+#ifdef DOXYGEN_ONLY
+		//! @brief Create array table filled with values from native range (anything that works with std::begin and std::end).
+		//! @details The table is presized for the whole range when the amount of elements is known in advance, see @ref assign for details.
+		//! @warning The range must outlive the result.
+		template<typename Range>
+		static Temporary fromRange(Context& context, const Range& range);
+#else	// Not DOXYGEN_ONLY
+		template<typename Range>
+		static _::Lazy<_::lazyTableRange<decltype(std::begin(std::declval<const Range&>()))>> fromRange(Context& S, const Range& range)
+		{
+			return _::Lazy<_::lazyTableRange<decltype(std::begin(range))>>(S, std::begin(range), std::end(range));
+		}
+#endif	// DOXYGEN_ONLY
+
+		//! @brief Copy array elements to output iterator.
+		//! @details Elements under keys 1..n (n being raw length, read once) are fetched with raw reads and converted to T.
+		//! Numbers are read in batches. Elements that cannot be converted are skipped, and the exception is thrown
+		//! only after all other elements have been copied.
+		//! @return Output iterator past the last copied element.
+		//! @throw std::runtime_error if some elements cannot be converted to T (reports their amount and the first key).
+		template<typename T, typename OutputIterator>
+		OutputIterator copyTo(OutputIterator out) const;
+
+		//! @brief Array elements converted to T.
+		//! @details Works like @ref copyTo, the vector is reserved for the whole array.
+		//! @throw std::runtime_error if some elements cannot be converted to T.
+		template<typename T>
+		std::vector<T> toVector() const;
+
+		//! @brief All key-value pairs (in traversal order, raw) converted to map type (e.g. std::map or std::unordered_map).
+		//! @details Pairs that cannot be converted to map's key and mapped types are skipped, and the exception is thrown
+		//! only after all other pairs have been inserted. String keys are matched exactly (numeric keys are not converted).
+		//! @throw std::runtime_error if some pairs cannot be converted.
+		template<typename Map>
+		Map toMap() const;
+		//! @}
+
+		//! @name Iteration
+		//! @{
+
+#ifdef DOXYGEN_ONLY
+		//! @brief Range of all key-value pairs for range-based <b>for</b> (lua_next traversal, raw).
+		//! @details Elements are structures with @ref Valref "key" and @ref Valref "value" members that refer
+		//! to two stack slots, reused on every step: @code{.cpp}
+		//! for(auto [k, v] : table.pairs())
+		//!     if(k.type() == lua::ValueType::String)
+		//!         std::cout << k.cast<std::string>() << " = " << v.cast<std::string>() << std::endl;
+		//! @endcode
+		//! The slots are released when the traversal finishes or the range is destroyed (e.g. after <b>break</b>).
+		//! The range refers to the table by its stack slot, so the Table must outlive the loop: iterating over
+		//! a temporary (<code>Table(context.global["t"]).pairs()</code>) is not allowed.
+		//! @note Key and value must not be modified (Lua requires keys intact for traversal), values created inside the loop
+		//! must be gone by the end of each step. During iteration any existing Valset will be blocked.
+		//! @warning Converting numeric key to string changes it in place and breaks the traversal: check the key type
+		//! first (as above) or convert a copy (@ref Value "Value" made from the key).
+		Range pairs() const noexcept;
+
+		//! @brief Range of array elements for range-based <b>for</b>.
+		//! @details Elements are structures with <b>size_t</b> index and @ref Valref "value" members. The raw length is read once
+		//! when the traversal starts, elements 1..n are read with raw access (no hashing of keys, metatable is ignored): @code{.cpp}
+		//! for(auto [i, v] : table.ipairs())
+		//!     sum += i * v.cast<double>();
+		//! @endcode
+		//! @note Restrictions of @ref pairs apply.
+		Range ipairs() const noexcept;
+#else	// Not DOXYGEN_ONLY
+		_::tablePairs pairs() const noexcept;
+		_::tableIPairs ipairs() const noexcept;
+#endif	// DOXYGEN_ONLY
+		//! @}
+
 
 	private:
 		//! Check if given value is indeed a table. Throws an exception if it's not.
@@ -353,6 +813,8 @@ namespace lua {
 		static void beginIteration(Context& S);
 		static bool nextIteration(const Value& v);
 
+		friend class _::tablePairs;
+
 		// data
 		Value Anchor;
 
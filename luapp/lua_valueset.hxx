@@ -356,7 +356,8 @@ namespace lua{
 		//! @details The created Valset will have 1 element inside.\n
 		//! If the expression was a function call that returned multiple values, the Valset will contain all returned values.\n
 		//! If the expression was a protected function call which ended succesfully, the Valset will contain all returned values.\n
-		//! Unsuccesfull protected call will put into Valset error description and the @ref Valset::success "success" status will be "false".
+		//! Unsuccesfull protected call will put into Valset error description and the @ref Valset::success "success" status will be "false".\n
+		//! The same applies to @ref lua::Coroutine::resume "coroutine resumption": the Valset will contain yielded or returned values, or error description.
 		Valset(Temporary src);
 
 		//! @brief Copy a value into set (works with Value and Table too).
@@ -380,6 +381,10 @@ namespace lua{
 		// Construct from protected call
 		template<typename Function, typename ... Args>
 		Valset(_::Lazy<_::lazyPCall<Function, Args...>>&& l, int rvAmount = -1);
+
+		// Construct from coroutine resumption
+		template<typename ... Args>
+		Valset(_::Lazy<_::lazyResume<Args...>>&& l);
 #endif	// DOXYGEN_ONLY
 		//! @brief Valset can be returned from functions but not actually moved.
 		Valset(Valset&&)/* = delete*/;
@@ -484,7 +489,7 @@ namespace lua{
 
 		//! @brief Protected call status.
 		//! @details If success() returns false, the protected call failed and Valset contains error message.
-		//! If Valset wasn't created from protected call, this function always returns true.
+		//! If Valset wasn't created from protected call or @ref lua::Coroutine::resume "coroutine resumption", this function always returns true.
 		bool success () const noexcept {return Success;}
 
 		//! @brief Blocked status.
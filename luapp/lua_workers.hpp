@@ -0,0 +1,489 @@
+/*
+* This file is part of Lua API++ library (https://github.com/OldFisher/lua-api-pp)
+* distributed under MIT License (http://opensource.org/licenses/MIT).
+* See license.txt for details.
+* (c) 2014 OldFisher
+*/
+
+#ifndef LUA_WORKERS_HPP_INCLUDED
+#define LUA_WORKERS_HPP_INCLUDED
+
+#include "lua.hpp"
+#include "luainc.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+
+//! @file
+//! @brief Worker threads running Lua states (optional, include separately).
+
+namespace lua {
+
+	//! @brief Lua value detached from any Lua state.
+	//! @details Holds nil, boolean, number or string. Used to pass arguments and results between threads,
+	//! so that no Lua object is shared between states.
+	class PlainValue {
+	public:
+		//! @brief Nil value.
+		PlainValue() noexcept:
+			kind(Kind::Nil)
+		{
+		}
+
+		PlainValue(std::nullptr_t) noexcept:
+			kind(Kind::Nil)
+		{
+		}
+
+		PlainValue(Nil) noexcept:
+			kind(Kind::Nil)
+		{
+		}
+
+		PlainValue(bool val) noexcept:
+			kind(Kind::Boolean),
+			boolean(val)
+		{
+		}
+
+#ifdef DOXYGEN_ONLY
+		//! @brief Number (integral types are kept as integers, floating point types as numbers).
+		template<typename T> PlainValue(T val) noexcept;
+#else
+		template<typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0> PlainValue(T val) noexcept:
+			kind(Kind::Integer),
+			integer(static_cast<long long>(val))
+		{
+		}
+
+		template<typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0> PlainValue(T val) noexcept:
+			kind(Kind::Number),
+			number(static_cast<double>(val))
+		{
+		}
+#endif	// DOXYGEN_ONLY
+
+		PlainValue(const char* val):
+			kind(Kind::String),
+			string(val)
+		{
+		}
+
+		PlainValue(std::string val) noexcept:
+			kind(Kind::String),
+			string(std::move(val))
+		{
+		}
+
+		//! @brief Type of contained value (Nil, Boolean, Number or String).
+		ValueType type() const noexcept
+		{
+			switch(kind) {
+			case Kind::Boolean:
+				return ValueType::Boolean;
+			case Kind::Integer:
+			case Kind::Number:
+				return ValueType::Number;
+			case Kind::String:
+				return ValueType::String;
+			default:
+				return ValueType::Nil;
+			}
+		}
+
+		//! @brief Check if the value is a number with integer representation (always false for Lua 5.1 and 5.2 values).
+		bool isInteger() const noexcept
+		{
+			return kind == Kind::Integer;
+		}
+
+#ifdef DOXYGEN_ONLY
+		//! @brief Get the contained value as bool, arithmetic type or std::string.
+		//! @details Integers and floating point numbers are converted to each other, no other conversions are made.
+		//! @throw std::runtime_error if the value has different type.
+		template<typename T> T cast() const;
+#else
+		template<typename T> typename std::enable_if<std::is_same<T, bool>::value, T>::type cast() const
+		{
+			if(kind != Kind::Boolean)
+				throw std::runtime_error("Lua: plain value is not a boolean");
+			return boolean;
+		}
+
+		template<typename T> typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, T>::type cast() const
+		{
+			if(kind == Kind::Integer)
+				return static_cast<T>(integer);
+			if(kind != Kind::Number)
+				throw std::runtime_error("Lua: plain value is not a number");
+			return static_cast<T>(number);
+		}
+
+		template<typename T> typename std::enable_if<std::is_same<T, std::string>::value, const std::string&>::type cast() const
+		{
+			if(kind != Kind::String)
+				throw std::runtime_error("Lua: plain value is not a string");
+			return string;
+		}
+#endif	// DOXYGEN_ONLY
+
+		//! @brief Push the value onto Lua stack.
+		void push(lua_State* L) const
+		{
+			switch(kind) {
+			case Kind::Boolean:
+				lua_pushboolean(L, boolean);
+				break;
+			case Kind::Integer:
+#if(LUAPP_API_VERSION >= 53)
+				lua_pushinteger(L, static_cast<lua_Integer>(integer));
+#else
+				lua_pushnumber(L, static_cast<lua_Number>(integer));
+#endif
+				break;
+			case Kind::Number:
+				lua_pushnumber(L, number);
+				break;
+			case Kind::String:
+				lua_pushlstring(L, string.data(), string.size());
+				break;
+			default:
+				lua_pushnil(L);
+			}
+		}
+
+		//! @brief Copy the value from Lua stack.
+		//! @throw std::runtime_error if the value is not nil, boolean, number or string.
+		static PlainValue read(lua_State* L, int index)
+		{
+			switch(lua_type(L, index)) {
+			case LUA_TNIL:
+				return PlainValue();
+			case LUA_TBOOLEAN:
+				return PlainValue(lua_toboolean(L, index) != 0);
+			case LUA_TNUMBER:
+#if(LUAPP_API_VERSION >= 53)
+				if(lua_isinteger(L, index))
+					return PlainValue(static_cast<long long>(lua_tointeger(L, index)));
+#endif
+				return PlainValue(static_cast<double>(lua_tonumber(L, index)));
+			case LUA_TSTRING: {
+				size_t len = 0;
+				const char* str = lua_tolstring(L, index, &len);
+				return PlainValue(std::string(str, len));
+			}
+			default:
+				throw std::runtime_error("Lua: only nil, boolean, number and string values can be passed between states");
+			}
+		}
+
+	private:
+		enum class Kind {Nil, Boolean, Integer, Number, String};
+
+		// data
+		Kind kind;
+		union {
+			bool boolean;
+			long long integer;
+			double number;
+		};
+		std::string string;
+	};
+
+
+
+	//! @cond
+	namespace _ {
+
+		//! @brief Link of intrusive multiple producers / single consumer queue.
+		struct MpscLink {
+			std::atomic<MpscLink*> next;
+		};
+
+		//! @brief Lock-free intrusive multiple producers / single consumer queue (non-blocking, unbounded).
+		//! @details Any thread may push, only one thread at a time may pop.
+		class MpscQueue {
+		public:
+			MpscQueue() noexcept:
+				head(&stub),
+				tail(&stub)
+			{
+				stub.next.store(nullptr, std::memory_order_relaxed);
+			}
+
+			MpscQueue(const MpscQueue&) = delete;
+			MpscQueue& operator = (const MpscQueue&) = delete;
+
+			void push(MpscLink* link) noexcept
+			{
+				link->next.store(nullptr, std::memory_order_relaxed);
+				MpscLink* const prev = head.exchange(link, std::memory_order_acq_rel);
+				prev->next.store(link, std::memory_order_release);
+			}
+
+			//! @brief Take the oldest link, nullptr if the queue is empty or the latest push is not finished yet.
+			MpscLink* pop() noexcept
+			{
+				MpscLink* first = tail;
+				MpscLink* next = first->next.load(std::memory_order_acquire);
+				if(first == &stub) {
+					if(!next)
+						return nullptr;
+					tail = next;
+					first = next;
+					next = next->next.load(std::memory_order_acquire);
+				}
+				if(next) {
+					tail = next;
+					return first;
+				}
+				if(first != head.load(std::memory_order_acquire))
+					return nullptr;
+				push(&stub);
+				next = first->next.load(std::memory_order_acquire);
+				if(next) {
+					tail = next;
+					return first;
+				}
+				return nullptr;
+			}
+
+			//! @brief Check for links available to consumer.
+			bool empty() const noexcept
+			{
+				return tail == &stub && !stub.next.load(std::memory_order_acquire);
+			}
+
+		private:
+			std::atomic<MpscLink*> head;
+			MpscLink* tail;
+			MpscLink stub;
+		};
+
+	}
+	//! @endcond
+
+
+
+	//! @brief Fixed set of threads, each owning its own Lua state.
+	//! @details Calls to global functions are submitted from any thread and executed by the workers.
+	//! Every worker has its own lock-free queue, calls are distributed round-robin unless a worker is chosen explicitly.
+	//! Arguments and results are @ref PlainValue "plain values", so no Lua object ever crosses a state boundary.
+	//! @code{.cpp}
+	//! Workers workers(4, [](State& s){ s.runFile("handlers.lua"); });
+	//! std::future<Workers::Values> reply = workers.call("handle", "request", 42);
+	//! std::string text = reply.get().at(0).cast<std::string>();
+	//! @endcode
+	//! @note A worker state is only accessed from its thread. Calls submitted to the same worker are executed in order.
+	//! Destructor waits for all submitted calls to complete.
+	class Workers {
+	public:
+		//! @brief State initializer, called once for every worker state.
+		typedef std::function<void(State&)> Initializer;
+
+		//! @brief Arguments or results of a call.
+		typedef std::vector<PlainValue> Values;
+
+		//! @param threads Amount of worker threads (and states); zero means one per hardware thread.
+		//! @param init Initializer called for every state before the workers are started (may be empty).
+		//! @param libraries Standard libraries opened in worker states (combination of @ref lua::lib::Library "library flags").
+		//! @throw std::runtime_error if a state cannot be created; exceptions thrown by initializer are propagated.
+		explicit Workers(size_t threads = 0, const Initializer& init = Initializer(), lib::Library libraries = lib::all):
+			stopping(false),
+			nextWorker(0)
+		{
+			if(!threads)
+				threads = std::max(std::thread::hardware_concurrency(), 1u);
+			workers.reserve(threads);
+			for(size_t i = 0; i < threads; ++i) {
+				std::unique_ptr<Worker> w(new Worker(libraries));
+				if(init)
+					init(w->state);
+				workers.push_back(std::move(w));
+			}
+			for(size_t i = 0; i < threads; ++i) {
+				try {
+					workers[i]->thread = std::thread(&Workers::run, this, std::ref(*workers[i]));
+				} catch(...) {
+					shutdown();
+					throw;
+				}
+			}
+		}
+
+		Workers(const Workers&) = delete;
+		Workers& operator = (const Workers&) = delete;
+
+		~Workers() noexcept
+		{
+			shutdown();
+		}
+
+		//! @brief Amount of workers.
+		size_t size() const noexcept
+		{
+			return workers.size();
+		}
+
+		//! @brief Call global function on the next worker.
+		//! @details Errors (including non-plain results) are reported by the returned future as std::runtime_error.
+		//! @throw std::bad_alloc
+		std::future<Values> submit(std::string function, Values args = Values())
+		{
+			return submit(nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size(), std::move(function), std::move(args));
+		}
+
+		//! @brief Call global function on a particular worker.
+		//! @pre worker < size()
+		//! @throw std::bad_alloc
+		//! @overload
+		std::future<Values> submit(size_t worker, std::string function, Values args = Values())
+		{
+			std::unique_ptr<Job> job(new Job(std::move(function), std::move(args)));
+			std::future<Values> result = job->result.get_future();
+			Worker& w = *workers[worker];
+			w.queue.push(job.release());
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if(w.waiting.load(std::memory_order_relaxed)) {
+				std::lock_guard<std::mutex> lock(w.guard);
+				w.wake.notify_one();
+			}
+			return result;
+		}
+
+		//! @brief Call global function on the next worker, arguments are converted to @ref PlainValue "plain values".
+		//! @throw std::bad_alloc
+		template<typename... Args> std::future<Values> call(std::string function, Args&&... args)
+		{
+			return submit(std::move(function), Values{PlainValue(std::forward<Args>(args))...});
+		}
+
+	private:
+		struct Job: _::MpscLink {
+			Job(std::string&& function, Values&& args):
+				function(std::move(function)),
+				args(std::move(args))
+			{
+			}
+
+			const std::string function;
+			const Values args;
+			std::promise<Values> result;
+		};
+
+		struct Worker {
+			explicit Worker(lib::Library libraries):
+				state(libraries),
+				waiting(false)
+			{
+			}
+
+			State state;
+			_::MpscQueue queue;
+			std::atomic<bool> waiting;
+			std::mutex guard;
+			std::condition_variable wake;
+			std::thread thread;
+		};
+
+		void run(Worker& w)
+		{
+			for(;;) {
+				if(_::MpscLink* link = w.queue.pop()) {
+					std::unique_ptr<Job> job(static_cast<Job*>(link));
+					try {
+						job->result.set_value(execute(w.state.getRawState(), job->function, job->args));
+					} catch(...) {
+						job->result.set_exception(std::current_exception());
+					}
+					continue;
+				}
+				std::unique_lock<std::mutex> lock(w.guard);
+				if(stopping.load(std::memory_order_relaxed) && w.queue.empty())
+					return;
+				w.waiting.store(true, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if(w.queue.empty() && !stopping.load(std::memory_order_relaxed))
+					w.wake.wait(lock);
+				w.waiting.store(false, std::memory_order_relaxed);
+			}
+		}
+
+		//! Function lookup and arguments passed to protected call
+		struct Call {
+			const std::string& function;
+			const Values& args;
+		};
+
+		//! Protected part of execution: global lookup (may run "__index" of _G), argument pushes and the call itself
+		static int callProtected(lua_State* L)
+		{
+			const Call& call = *static_cast<const Call*>(lua_touserdata(L, 1));
+			lua_pop(L, 1);
+			luaL_checkstack(L, static_cast<int>(call.args.size()) + 1, "too many arguments for worker call");
+			lua_getglobal(L, call.function.c_str());
+			for(const auto& arg : call.args)
+				arg.push(L);
+			lua_call(L, static_cast<int>(call.args.size()), LUA_MULTRET);
+			return lua_gettop(L);
+		}
+
+		static Values execute(lua_State* L, const std::string& function, const Values& args)
+		{
+			const int base = lua_gettop(L);
+			if(!lua_checkstack(L, 2))
+				throw std::runtime_error("Lua: stack overflow");
+			Call call{function, args};
+			lua_pushcfunction(L, &callProtected);
+			lua_pushlightuserdata(L, &call);
+			if(lua_pcall(L, 1, LUA_MULTRET, 0) != 0) {
+				const std::string msg(lua_isstring(L, -1) ? lua_tostring(L, -1) : "Lua: unknown error in worker call");
+				lua_settop(L, base);
+				throw std::runtime_error(msg);
+			}
+			const int top = lua_gettop(L);
+			Values results;
+			try {
+				results.reserve(top - base);
+				for(int i = base + 1; i <= top; ++i)
+					results.push_back(PlainValue::read(L, i));
+			} catch(...) {
+				lua_settop(L, base);
+				throw;
+			}
+			lua_settop(L, base);
+			return results;
+		}
+
+		void shutdown() noexcept
+		{
+			for(auto& w : workers) {
+				std::lock_guard<std::mutex> lock(w->guard);
+				stopping.store(true, std::memory_order_relaxed);
+				w->wake.notify_one();
+			}
+			for(auto& w : workers)
+				if(w->thread.joinable())
+					w->thread.join();
+		}
+
+		// data
+		std::atomic<bool> stopping;
+		std::atomic<size_t> nextWorker;
+		std::vector<std::unique_ptr<Worker>> workers;
+	};
+
+}
+
+#endif // LUA_WORKERS_HPP_INCLUDED
@@ -30,6 +30,7 @@ namespace lua {
 
 			//! Default argument conversion routine (simple cast).
 			//! Specialized for certain type if necessary.
+			//! StringRef and string_view arguments refer to the strings in argument slots, which outlive the call.
 			template<typename ValType>
 			inline typename std::conditional<::lua::TypeID<ValType>::typeID == ::lua::ValueType::UserData, ValType&, ValType>::type argCvt(const ::lua::Valref& value)
 			{
@@ -37,13 +38,24 @@ namespace lua {
 			}
 
 
-			//! Default return type converter.
+			//! Return type converter for families of types.
 			//! Pushes the value "as is".
+			//! Specialize partially if necessary (e.g. for class templates).
+			template<typename ResultType>
+			struct RvConvert {
+				static Retval convert(ResultType&& rv, Context& s)
+				{
+					return s.ret(rv);
+				}
+			};
+
+			//! Default return type converter.
+			//! Uses RvConvert.
 			//! Specialize if necessary.
 			template<typename ResultType>
 			inline Retval rvCvt(ResultType rv, Context& s)
 			{
-				return s.ret(rv);
+				return RvConvert<ResultType>::convert(std::move(rv), s);
 			}
 
 
@@ -68,74 +80,245 @@ namespace lua {
 			}
 
 
-			//! Make a call with argument transformation, return result
-			template<typename ReturnValueType, typename ... ArgTypes, size_t ... Indices>
-			inline ReturnValueType makeCall(Context& s, ReturnValueType (*f)(ArgTypes...), PackIndices<Indices...>)
-			{
-				return f(argCvt<typename std::decay<ArgTypes>::type>(s.args.at(Indices))...);
-			}
+			//! Type of converted argument
+			template<typename ValType>
+			struct ArgType {
+				typedef typename std::conditional<::lua::TypeID<ValType>::typeID == ::lua::ValueType::UserData, ValType&, ValType>::type type;
+			};
+
+			//! Type used to verify the argument in advance.
+			//! Types with custom conversion are not verified, neither is bool: any value converts to it, same as in regular wrappers.
+			template<typename ValType>
+			struct ArgCheckType {
+				typedef typename std::conditional<::lua::TypeID<ValType>::typeID == ::lua::ValueType::None || std::is_same<ValType, bool>::value, void, ValType>::type type;
+			};
+
+			//! Conversion of the argument that is known to have correct type
+			template<typename ValType, ValueType = ::lua::TypeID<ValType>::typeID>
+			struct FastArg {
+				static typename ArgType<ValType>::type get(const ::lua::Valref& value)
+				{
+					return argCvt<ValType>(value);
+				}
+			};
+
+			template<typename ValType>
+			struct FastArg<ValType, ValueType::Number> {
+				static ValType get(const ::lua::Valref& value)
+				{
+					return value.to<ValType>();
+				}
+			};
+
+			template<typename ValType>
+			struct FastArg<ValType, ValueType::UserData> {
+				static ValType& get(const ::lua::Valref& value)
+				{
+					return *static_cast<ValType*>(value.to<LightUserData>());
+				}
+			};
+
+			//! Argument fetching with range and type checks for every argument
+			template<bool Fast>
+			struct ArgFetch {
+				template<typename ...>
+				static bool verify(Context&) noexcept
+				{
+					return true;
+				}
+
+				template<typename ValType>
+				static typename ArgType<ValType>::type get(const Valset& args, size_t idx)
+				{
+					return argCvt<ValType>(args.at(idx));
+				}
+			};
+
+			//! Argument fetching with all arguments verified at once before the call
+			template<>
+			struct ArgFetch<true> {
+				template<typename ... ArgTypes>
+				static bool verify(Context& c)
+				{
+					if(c.checkArgs<typename ArgCheckType<ArgTypes>::type...>())
+						return true;
+					c.requireArgs<typename ArgCheckType<ArgTypes>::type...>();	// raises an error
+					return false;
+				}
+
+				template<typename ValType>
+				static typename ArgType<ValType>::type get(const Valset& args, size_t idx)
+				{
+					return FastArg<ValType>::get(args[idx]);
+				}
+			};
+
+
+			//! Conversion of the call result, Invoker provides verify and invoke functions
+			template<typename Invoker, typename ReturnValueType, size_t ArgNum>
+			struct InvokeReturn {
+				static Retval call(Context& c)
+				{
+					if(!Invoker::verify(c))
+						return c.ret();
+					return rvCvt<typename std::decay<ReturnValueType>::type>(Invoker::invoke(c, typename CreatePackIndices<ArgNum>::type()), c);
+				}
+			};
+
+			template<typename Invoker, size_t ArgNum>
+			struct InvokeReturn<Invoker, void, ArgNum> {
+				static Retval call(Context& c)
+				{
+					if(Invoker::verify(c))
+						Invoker::invoke(c, typename CreatePackIndices<ArgNum>::type());
+					return c.ret();
+				}
+			};
+
+			//! Result type passed to InvokeReturn (void if the result is discarded)
+			template<typename ReturnValueType, bool Discard>
+			struct ResultType {
+				typedef typename std::conditional<Discard, void, ReturnValueType>::type type;
+			};
+
+			//! Call to a function (or function object) provided by Source
+			template<typename Source, bool Fast, bool Discard, typename ReturnValueType, typename ... ArgTypes>
+			struct FunctionInvoker: public InvokeReturn<FunctionInvoker<Source, Fast, Discard, ReturnValueType, ArgTypes...>, typename ResultType<ReturnValueType, Discard>::type, sizeof...(ArgTypes)> {
+				static bool verify(Context& c)
+				{
+					return ArgFetch<Fast>::template verify<typename std::decay<ArgTypes>::type...>(c);
+				}
+
+				template<size_t ... Indices>
+				static ReturnValueType invoke(Context& c, PackIndices<Indices...>)
+				{
+					return Source::get(c)(ArgFetch<Fast>::template get<typename std::decay<ArgTypes>::type>(c.args, Indices)...);
+				}
+			};
+
+			//! Call to a member function provided by Source
+			template<typename Source, bool Fast, bool Discard, typename Host, typename ReturnValueType, typename ... ArgTypes>
+			struct MemberInvoker: public InvokeReturn<MemberInvoker<Source, Fast, Discard, Host, ReturnValueType, ArgTypes...>, typename ResultType<ReturnValueType, Discard>::type, sizeof...(ArgTypes)> {
+				static bool verify(Context& c)
+				{
+					return ArgFetch<Fast>::template verify<Host, typename std::decay<ArgTypes>::type...>(c);
+				}
+
+				template<size_t ... Indices>
+				static ReturnValueType invoke(Context& c, PackIndices<Indices...>)
+				{
+					return (ArgFetch<Fast>::template get<Host>(c.args, 0).*Source::get(c))(ArgFetch<Fast>::template get<typename std::decay<ArgTypes>::type>(c.args, 1 + Indices)...);
+				}
+			};
 
+			//! Selection of invoker by function pointer type
+			template<typename FP>
+			struct InvokerSelector;
 
-			//! Wrap a call
 			template<typename ReturnValueType, typename ... ArgTypes>
-			Retval call(Context& s)
-			{
-				typedef ReturnValueType (*fp)(ArgTypes...);
-				fp f = getReservedFptr<fp>(s);
-				return rvCvt<typename std::decay<ReturnValueType>::type>(makeCall(s, f, typename CreatePackIndices<sizeof...(ArgTypes)>::type()), s);
-			}
+			struct InvokerSelector<ReturnValueType (*)(ArgTypes...)> {
+				template<typename Source, bool Fast, bool Discard = false> using type = FunctionInvoker<Source, Fast, Discard, ReturnValueType, ArgTypes...>;
+			};
 
+			template<typename Host, typename ReturnValueType, typename ... ArgTypes>
+			struct InvokerSelector<ReturnValueType (Host::*)(ArgTypes...)> {
+				template<typename Source, bool Fast, bool Discard = false> using type = MemberInvoker<Source, Fast, Discard, Host, ReturnValueType, ArgTypes...>;
+			};
 
-			//! Call to a void function with argument transformation
-			template<typename ReturnValueType, typename ... ArgTypes, size_t ... Indices>
-			inline void makeCallv(Context& s, ReturnValueType (*f)(ArgTypes...), PackIndices<Indices...>)
-			{
-				f(argCvt<typename std::decay<ArgTypes>::type>(s.args.at(Indices))...);
-			}
+			template<typename Host, typename ReturnValueType, typename ... ArgTypes>
+			struct InvokerSelector<ReturnValueType (Host::*)(ArgTypes...) const> {
+				template<typename Source, bool Fast, bool Discard = false> using type = MemberInvoker<Source, Fast, Discard, Host, ReturnValueType, ArgTypes...>;
+			};
 
-			//! Wrap a call to a function discarding return value
-			template<typename ReturnType, typename ... ArgTypes>
-			Retval callv(Context& s)
-			{
-				typedef ReturnType (*fp)(ArgTypes...);
-				fp f = getReservedFptr<fp>(s);
-				makeCallv(s, f, typename CreatePackIndices<sizeof...(ArgTypes)>::type());
-				return s.ret();
-			}
+#ifdef __cpp_noexcept_function_type
+			template<typename ReturnValueType, typename ... ArgTypes>
+			struct InvokerSelector<ReturnValueType (*)(ArgTypes...) noexcept> {
+				template<typename Source, bool Fast, bool Discard = false> using type = FunctionInvoker<Source, Fast, Discard, ReturnValueType, ArgTypes...>;
+			};
 
-			//! Make a call to member function with argument transformation, return result
-			template<typename Host, typename ReturnValueType, typename ... ArgTypes, size_t ... Indices>
-			inline ReturnValueType makeMemberCall(Context& c, ReturnValueType (Host::*f)(ArgTypes...), PackIndices<Indices...>)
-			{
-				return (argCvt<Host>(c.args.at(0)).*f)(argCvt<typename std::decay<ArgTypes>::type>(c.args.at(1 + Indices))...);
-			}
+			template<typename Host, typename ReturnValueType, typename ... ArgTypes>
+			struct InvokerSelector<ReturnValueType (Host::*)(ArgTypes...) noexcept> {
+				template<typename Source, bool Fast, bool Discard = false> using type = MemberInvoker<Source, Fast, Discard, Host, ReturnValueType, ArgTypes...>;
+			};
+
+			template<typename Host, typename ReturnValueType, typename ... ArgTypes>
+			struct InvokerSelector<ReturnValueType (Host::*)(ArgTypes...) const noexcept> {
+				template<typename Source, bool Fast, bool Discard = false> using type = MemberInvoker<Source, Fast, Discard, Host, ReturnValueType, ArgTypes...>;
+			};
+#endif	// noexcept function types
+
+			//! Function pointer known at compile time
+			template<typename FP, FP fn>
+			struct StaticSource {
+				static FP get(Context&) noexcept
+				{
+					return fn;
+				}
+			};
 
+			//! Function pointer stored in upvalue[1]
+			template<typename FP>
+			struct ReservedSource {
+				static FP get(Context& c)
+				{
+					return getReservedFptr<FP>(c);
+				}
+			};
+
+			//! Wrapper for function known at compile time
+			template<typename FP, FP fn, bool Fast>
+			struct StaticCall: public InvokerSelector<FP>::template type<StaticSource<FP, fn>, Fast> {
+			};
+
+			//! Function object stored in upvalue[1] as userdata
+			template<typename F>
+			struct FunctorSource {
+				static F& get(Context& c)
+				{
+					return *static_cast<F*>(getRawReserve(c));
+				}
+			};
+
+			//! Wrapper for function stored in upvalue[1], result is dropped if Discard is set
+			template<typename FP, bool Fast, bool Discard>
+			struct ReservedCall: public InvokerSelector<FP>::template type<ReservedSource<FP>, Fast, Discard> {
+			};
+
+			//! Call to function object stored in upvalue[1] as userdata, Signature is the type of its call operator
+			template<typename F, typename Host, typename ReturnValueType, typename ... ArgTypes>
+			struct Functor<F, ReturnValueType (Host::*)(ArgTypes...)>: public FunctionInvoker<FunctorSource<F>, false, false, ReturnValueType, ArgTypes...> {
+			};
 
-			//! Make member call
-			template<typename Host, typename ReturnType, typename ... ArgTypes>
-			Retval memberCall(Context& c)
+			//! Call to function object with LFunction signature
+			template<typename F, typename Host>
+			struct Functor<F, Retval (Host::*)(Context&)> {
+				static Retval call(Context& c)
+				{
+					return FunctorSource<F>::get(c)(c);
+				}
+			};
+
+			//! Const call operator (not mutable lambda)
+			template<typename F, typename Host, typename ReturnValueType, typename ... ArgTypes>
+			struct Functor<F, ReturnValueType (Host::*)(ArgTypes...) const>:
+				public Functor<F, ReturnValueType (Host::*)(ArgTypes...)>
 			{
-				using fp = ReturnType (Host::*)(ArgTypes...);
-				fp f = getReservedFptr<fp>(c);
-				return rvCvt<typename std::decay<ReturnType>::type>(makeMemberCall(c, f, typename CreatePackIndices<sizeof...(ArgTypes)>::type()), c);
-			}
+			};
 
-			//! Make a call to member function with argument transformation, discard result
-			template<typename Host, typename ReturnValueType, typename ... ArgTypes, size_t ... Indices>
-			inline void makeMemberCallv(Context& c, ReturnValueType (Host::*f)(ArgTypes...), PackIndices<Indices...>)
+#ifdef __cpp_noexcept_function_type
+			//! noexcept call operators (part of the function type since C++17)
+			template<typename F, typename Host, typename ReturnValueType, typename ... ArgTypes>
+			struct Functor<F, ReturnValueType (Host::*)(ArgTypes...) noexcept>:
+				public Functor<F, ReturnValueType (Host::*)(ArgTypes...)>
 			{
-				(argCvt<Host>(c.args.at(0)).*f)(argCvt<typename std::decay<ArgTypes>::type>(c.args.at(1 + Indices))...);
-			}
+			};
 
-			//! Make member call for void-function
-			template<typename Host, typename ReturnType, typename ... ArgTypes>
-			Retval memberCallv(Context& c)
+			template<typename F, typename Host, typename ReturnValueType, typename ... ArgTypes>
+			struct Functor<F, ReturnValueType (Host::*)(ArgTypes...) const noexcept>:
+				public Functor<F, ReturnValueType (Host::*)(ArgTypes...)>
 			{
-				using fp = ReturnType (Host::*)(ArgTypes...);
-				fp f = getReservedFptr<fp>(c);
-				makeMemberCallv(c, f, typename CreatePackIndices<sizeof...(ArgTypes)>::type());
-				return c.ret();
-			}
+			};
+#endif	// noexcept function types
 
 
 
@@ -0,0 +1,187 @@
+#include <boost/test/unit_test.hpp>
+
+#include "fixtures.h"
+#if defined(__cpp_impl_coroutine) && (LUAPP_API_VERSION >= 52)
+#include "luapp/lua_async.hpp"
+#include <stdexcept>
+#include <string>
+
+using lua::Context;
+using lua::Coroutine;
+using lua::async::Scheduler;
+using lua::async::Task;
+using std::string;
+
+
+
+static Task<int> delayedDouble(Scheduler& sched, int x)
+{
+	co_await sched.schedule();
+	co_return x * 2;
+}
+
+static Task<int> immediate(int x)
+{
+	co_return x + 1;
+}
+
+static Task<string> failing(Scheduler& sched)
+{
+	co_await sched.schedule();
+	throw std::runtime_error("task failed");
+}
+
+static Task<int> nested(Scheduler& sched, int x)
+{
+	const int a = co_await delayedDouble(sched, x);
+	const int b = co_await delayedDouble(sched, a);
+	co_return a + b;
+}
+
+static Task<void> touch(Scheduler& sched, int& counter)
+{
+	co_await sched.schedule();
+	++counter;
+}
+
+//! Counts destruction of coroutine frame holding it
+struct FrameGuard {
+	explicit FrameGuard(int& counter_): counter(&counter_) {}
+	FrameGuard(FrameGuard&& src) noexcept: counter(src.counter) {src.counter = nullptr;}
+	~FrameGuard() {if(counter) ++*counter;}
+	int* counter;
+};
+
+static Task<int> guarded(Scheduler& sched, FrameGuard)
+{
+	co_await sched.schedule();
+	co_return 1;
+}
+
+
+
+BOOST_AUTO_TEST_SUITE(AsyncTasks)
+
+
+
+BOOST_FIXTURE_TEST_CASE(AwaitFromLua, fxContext)
+{
+	Scheduler sched(context);
+	context.global["double"] = context.wrap([&sched](int x){ return delayedDouble(sched, x); });
+	context.runString("results = {}");
+	sched.spawn(context.chunk("local x = ... results[1] = double(x) results[2] = double(results[1])"), 5);
+	BOOST_CHECK_EQUAL(sched.size(), 1);
+	BOOST_CHECK(context.global["results"][1].type() == lua::ValueType::Nil);
+	sched.run();
+	BOOST_CHECK_EQUAL(sched.size(), 0);
+	BOOST_CHECK_EQUAL(context.global["results"][1].cast<int>(), 10);
+	BOOST_CHECK_EQUAL(context.global["results"][2].cast<int>(), 20);
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(CompletedSynchronously, fxContext)
+{
+	context.global["immediate"] = context.wrap(immediate);
+	// completed task does not yield, so it works outside of coroutines too
+	context.runString("value = immediate(41)");
+	BOOST_CHECK_EQUAL(context.global["value"].cast<int>(), 42);
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(OutsideCoroutine, fxContext)
+{
+	Scheduler sched(context);
+	context.global["double"] = context.wrap([&sched](int x){ return delayedDouble(sched, x); });
+	BOOST_CHECK_THROW(context.runString("double(1)"), std::runtime_error);
+	sched.runOnce();
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(TaskErrors, fxContext)
+{
+	Scheduler sched(context);
+	context.global["failing"] = context.wrap([&sched]{ return failing(sched); });
+	context.runString("caught = false");
+	sched.spawn(context.chunk("caught = not pcall(failing)"));
+	sched.run();
+	BOOST_CHECK_EQUAL(context.global["caught"].cast<bool>(), true);
+	sched.spawn(context.chunk("failing()"));
+	BOOST_CHECK_THROW(sched.run(), std::runtime_error);
+	BOOST_CHECK_EQUAL(sched.size(), 0);
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(NestedTasks, fxContext)
+{
+	Scheduler sched(context);
+	context.global["nested"] = context.wrap([&sched](int x){ return nested(sched, x); });
+	sched.spawn(context.chunk("result = nested(3)"));
+	sched.run();
+	BOOST_CHECK_EQUAL(context.global["result"].cast<int>(), 18);
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(ManyTasks, fxContext)
+{
+	Scheduler sched(context);
+	int counter = 0;
+	context.global["touch"] = context.wrap([&sched, &counter]{ return touch(sched, counter); });
+	context.global["double"] = context.wrap([&sched](int x){ return delayedDouble(sched, x); });
+	context.runString("total = 0");
+	for(int i = 0; i < 500; ++i)
+		sched.spawn(context.chunk("local x = ... touch() coroutine.yield() total = total + double(x)"), i);
+	BOOST_CHECK_EQUAL(sched.size(), 500);
+	sched.run();
+	BOOST_CHECK_EQUAL(counter, 500);
+	BOOST_CHECK_EQUAL(context.global["total"].cast<int>(), 499 * 500);
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(UnclaimedTasks, fxContext)
+{
+	Scheduler sched(context);
+	int destroyed = 0;
+	context.global["guarded"] = context.wrap([&sched, &destroyed]{ return guarded(sched, FrameGuard(destroyed)); });
+
+	// yield across C-call boundary fails
+	sched.spawn(context.chunk("ok = pcall(table.sort, {2, 1}, function(a, b) guarded() return a < b end)"));
+	sched.run();
+	BOOST_CHECK_EQUAL(context.global["ok"].cast<bool>(), false);
+	context.runString("collectgarbage()");
+	sched.run();
+	BOOST_CHECK_EQUAL(destroyed, 1);
+
+	// yield reaches coroutine.resume called by Lua code
+	context.runString("local co = coroutine.create(function() return guarded() end) ok = coroutine.resume(co)");
+	BOOST_CHECK_EQUAL(context.global["ok"].cast<bool>(), true);
+	context.runString("collectgarbage()");
+	BOOST_CHECK_EQUAL(destroyed, 1);	// still running
+	sched.run();
+	BOOST_CHECK_EQUAL(destroyed, 2);
+
+	// claimed by scheduler
+	sched.spawn(context.chunk("result = guarded()"));
+	sched.run();
+	context.runString("collectgarbage()");
+	BOOST_CHECK_EQUAL(context.global["result"].cast<int>(), 1);
+	BOOST_CHECK_EQUAL(destroyed, 3);
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif	// C++20 coroutines, V52+
@@ -46,6 +46,37 @@ BOOST_FIXTURE_TEST_CASE(garbageCollector, fxContext)
 
 
 
+BOOST_FIXTURE_TEST_CASE(garbageCollectorTuning, fxContext)
+{
+	const int pause = context.gcSetPause(150);
+	BOOST_CHECK_EQUAL(context.gcSetPause(pause), 150);
+	const int stepmul = context.gcSetStepMultiplier(300);
+	BOOST_CHECK_EQUAL(context.gcSetStepMultiplier(stepmul), 300);
+
+	context.runString("garbage = {} for i = 1, 10000 do garbage[i] = {} end garbage = nil");
+	bool finished = false;
+	for(int i = 0; i < 100000 && !finished; ++i)
+		finished = context.gcStep();
+	BOOST_CHECK(finished);
+	BOOST_CHECK(context.gcStep(1 << 20));
+
+	context.runString("garbage = {} for i = 1, 10000 do garbage[i] = {} end garbage = nil");
+	finished = false;
+	for(int i = 0; i < 100000 && !finished; ++i)
+		finished = context.gcStepFor(0);	// zero budget still makes a single step
+	BOOST_CHECK(finished);
+	BOOST_CHECK(context.gcStepFor(1000000));
+
+#if(LUAPP_API_VERSION == 52)
+	context.gcGenerational();
+	context.gcCollect();
+	context.gcIncremental();
+	context.gcCollect();
+#endif	// V52
+}
+
+
+
 BOOST_FIXTURE_TEST_CASE(directLua, fxContext)
 {
 	BOOST_CHECK_EQUAL(gs.getRawState(), static_cast<lua_State*>(context));
@@ -1,6 +1,9 @@
 #include <boost/test/unit_test.hpp>
 
 #include "fixtures.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <stdexcept>
 
 using std::string;
@@ -106,6 +109,191 @@ BOOST_FIXTURE_TEST_CASE(CreateChunkFromFileStdStr, fxFiles)
 
 
 
+BOOST_FIXTURE_TEST_CASE(CachedChunks, fxContext)
+{
+	Value c1 = context.cachedChunk("return 1, \"a string\"");
+	Value c2 = context.cachedChunk(string("return 1, \"a string\""));
+	Value c3 = context.cachedChunk("return 2");
+	BOOST_CHECK(c1 == c2);
+	BOOST_CHECK(c1 != c3);
+	Valset result = c2.pcall();
+	BOOST_CHECK(result.success());
+	BOOST_CHECK_EQUAL(result.size(), 2);
+	BOOST_CHECK_EQUAL(result[0].cast<int>(), 1);
+	BOOST_CHECK_EQUAL(result[1].cast<string>(), "a string");
+	BOOST_CHECK_EQUAL(c3().cast<int>(), 2);
+	BOOST_CHECK_THROW(Value v = context.cachedChunk("{"), std::runtime_error);
+
+	context.clearChunkCache();
+	Value c4 = context.cachedChunk("return 1, \"a string\"");
+	BOOST_CHECK(c1 != c4);
+
+	context.setChunkCacheLimit(1);
+	Value c5 = context.cachedChunk("return 2");
+	Value c6 = context.cachedChunk("return 1, \"a string\"");
+	BOOST_CHECK(c4 != c6);
+	BOOST_CHECK(context.cachedChunk("return 1, \"a string\"") == c6);
+
+	context.setChunkCacheLimit(3);
+	const char* const texts[] = {"return 1", "return 2", "return 3"};
+	Value cached[3] = {context.cachedChunk(texts[0]), context.cachedChunk(texts[1]), context.cachedChunk(texts[2])};
+	context.setChunkCacheLimit(2);	// the oldest chunk is dropped
+	BOOST_CHECK(context.cachedChunk(texts[1]) == cached[1]);
+	BOOST_CHECK(context.cachedChunk(texts[2]) == cached[2]);
+	BOOST_CHECK(context.cachedChunk(texts[0]) != cached[0]);	// stored again, replacing texts[1]
+	BOOST_CHECK(context.cachedChunk(texts[2]) == cached[2]);
+	BOOST_CHECK(context.cachedChunk(texts[1]) != cached[1]);
+
+	context.setChunkCacheLimit(0);
+	Value c7 = context.cachedChunk("return 2");
+	BOOST_CHECK(context.cachedChunk("return 2") != c7);
+	BOOST_CHECK_EQUAL(c7().cast<int>(), 2);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(CachedFileChunks, fxFiles)
+{
+	context.runString("function fnSignal() signal = true end");
+	Value c1 = context.cachedLoad("test_good.lua");
+	Value c2 = context.cachedLoad(string("test_good.lua"));
+	BOOST_CHECK(c1 == c2);
+	c2();
+	BOOST_CHECK(context.global["signal"].cast<bool>());
+	BOOST_CHECK_THROW(Value v = context.cachedLoad("test_bad.lua"), std::runtime_error);
+	BOOST_CHECK_THROW(Value v = context.cachedLoad("nosuchfile.lua"), std::runtime_error);
+	context.clearChunkCache();
+	BOOST_CHECK(context.cachedLoad("test_good.lua") != c1);
+
+	// modification within the same second is detected
+	const char* const fileName = "test_cached.lua";
+	{
+		std::ofstream file(fileName);
+		file << "return 1";
+	}
+	BOOST_CHECK_EQUAL(context.cachedLoad(fileName)().cast<int>(), 1);
+	{
+		std::ofstream file(fileName);
+		file << "return 22";
+	}
+	BOOST_CHECK_EQUAL(context.cachedLoad(fileName)().cast<int>(), 22);
+	std::remove(fileName);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(DumpAndLoadBuffer, fxContext)
+{
+	Value c = context.chunk("local x = ... return x * 2, \"a string\"");
+	const string bytecode = context.dump(c);
+	BOOST_CHECK(!bytecode.empty());
+	string streamed;
+	size_t pieces = 0;
+	context.dump(c, [&](const void* data, size_t size){streamed.append(static_cast<const char*>(data), size); ++pieces;});
+	BOOST_CHECK(streamed == bytecode);
+	BOOST_CHECK_GT(pieces, 0);
+
+	Value loaded = context.loadBuffer(bytecode);
+	Valset result = loaded.pcall(21);
+	BOOST_CHECK(result.success());
+	BOOST_CHECK_EQUAL(result.size(), 2);
+	BOOST_CHECK_EQUAL(result[0].cast<int>(), 42);
+	BOOST_CHECK_EQUAL(result[1].cast<string>(), "a string");
+	BOOST_CHECK_EQUAL(context.loadBuffer(bytecode.data(), bytecode.size(), "=dumped")(1).cast<int>(), 2);
+
+	const string text = "return 3";
+	BOOST_CHECK_THROW(Value v = context.loadBuffer(text), std::runtime_error);
+	BOOST_CHECK_EQUAL(context.loadBuffer(text, "=text", lua::ChunkMode::Text)().cast<int>(), 3);
+	BOOST_CHECK_EQUAL(context.loadBuffer(text, "=text", lua::ChunkMode::Any)().cast<int>(), 3);
+	BOOST_CHECK_THROW(Value v = context.loadBuffer(bytecode, "=text", lua::ChunkMode::Text), std::runtime_error);
+
+	BOOST_CHECK_THROW(context.dump(context.wrap([](int x){return x;})), std::runtime_error);
+	BOOST_CHECK_THROW(context.dump(c, [](const void*, size_t){throw std::logic_error("writer");}), std::logic_error);
+	const size_t top = context.getTop();
+	BOOST_CHECK_NO_THROW(context.dump(c, true));
+	BOOST_CHECK_EQUAL(context.getTop(), top);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(CreateChunkFromMappedFile, fxFiles)
+{
+	context.runString("function fnSignal() signal = true end");
+	Value c = context.loadMapped("test_good.lua");
+	c();
+	BOOST_CHECK(context.global["signal"].cast<bool>());
+	BOOST_CHECK_THROW(Value v = context.loadMapped("test_bad.lua"), std::runtime_error);
+	BOOST_CHECK_THROW(Value v = context.loadMapped(string("nosuchfile.lua")), std::runtime_error);
+	BOOST_CHECK_THROW(Value v = context.loadMapped("test_good.lua", lua::ChunkMode::Binary), std::runtime_error);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(CreateChunkFromMappedBytecode, fxContext)
+{
+	const string bytecode = context.dump(context.chunk("local x = ... return x * 2, \"a string\""));
+	const char* const fileName = "test_bytecode.luac";
+	{
+		std::ofstream file(fileName, std::ios::binary);
+		file.write(bytecode.data(), bytecode.size());
+	}
+	Valset result = context.loadMapped(fileName, lua::ChunkMode::Binary).pcall(21);
+	BOOST_CHECK(result.success());
+	BOOST_CHECK_EQUAL(result.size(), 2);
+	BOOST_CHECK_EQUAL(result[0].cast<int>(), 42);
+	BOOST_CHECK_EQUAL(result[1].cast<string>(), "a string");
+	BOOST_CHECK_EQUAL(context.loadMapped(fileName)(1).cast<int>(), 2);
+	BOOST_CHECK_THROW(Value v = context.loadMapped(fileName, lua::ChunkMode::Text), std::runtime_error);
+	std::remove(fileName);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(CreateChunkFromReader, fxContext)
+{
+	using lua::StringRef;
+	const char* const pieces[] = {"local x = ... ", "return x * ", "2, \"a string\""};
+	size_t next = 0;
+	auto reader = [&]() -> StringRef {
+		if(next == 3)
+			return StringRef{nullptr, 0};
+		const char* const piece = pieces[next++];
+		return StringRef{piece, std::strlen(piece)};
+	};
+	Value c = context.load(reader, "=pieces");
+	BOOST_CHECK_EQUAL(next, 3);
+	Valset result = c.pcall(21);
+	BOOST_CHECK(result.success());
+	BOOST_CHECK_EQUAL(result.size(), 2);
+	BOOST_CHECK_EQUAL(result[0].cast<int>(), 42);
+	BOOST_CHECK_EQUAL(result[1].cast<string>(), "a string");
+
+	next = 0;
+	BOOST_CHECK_EQUAL(context.load(reader)(4).cast<int>(), 8);
+	next = 0;
+	BOOST_CHECK_THROW(Value v = context.load(reader, "=pieces", lua::ChunkMode::Binary), std::runtime_error);
+
+	const string bytecode = context.dump(c);
+	bool done = false;
+	Value loaded = context.load([&]() -> StringRef {
+		if(done)
+			return StringRef{nullptr, 0};
+		done = true;
+		return StringRef{bytecode.data(), bytecode.size()};
+	}, "=bytecode", lua::ChunkMode::Binary);
+	BOOST_CHECK_EQUAL(loaded(5).cast<int>(), 10);
+
+	done = false;
+	BOOST_CHECK_THROW(Value v = context.load([&]() -> StringRef {
+		const bool first = !done;
+		done = true;
+		return first ? StringRef{"{", 1} : StringRef{nullptr, 0};
+	}), std::runtime_error);
+	BOOST_CHECK_THROW(Value v = context.load([]() -> StringRef {throw std::logic_error("reader");}), std::logic_error);
+}
+
+
+
 BOOST_FIXTURE_TEST_CASE(RunString, fxContext)
 {
 	BOOST_CHECK_THROW(context.runString("{"), std::runtime_error);
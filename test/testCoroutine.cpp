@@ -0,0 +1,169 @@
+#include <boost/test/unit_test.hpp>
+
+#include "fixtures.h"
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using lua::Context;
+using lua::Coroutine;
+using lua::Retval;
+using lua::Valset;
+using lua::Value;
+using std::string;
+
+
+
+static Retval lYieldArg(Context& c)
+{
+	return c.yield(c.args[0]);
+}
+
+#if(LUAPP_API_VERSION >= 52)
+static Retval lDoubleResumed(Context& c)
+{
+	return c.ret(c.args[0].cast<int>() * 2);
+}
+
+static Retval lYieldThenDouble(Context& c)
+{
+	return c.yieldk(lDoubleResumed, c.args[0], "second");
+}
+#endif	// V52+
+
+
+
+BOOST_AUTO_TEST_SUITE(CoroutineObject)
+
+
+
+BOOST_FIXTURE_TEST_CASE(ResumeLuaFunction, fxContext)
+{
+	Coroutine co(context.chunk("local x = ... while x < 100 do x = x + coroutine.yield(x, 'step') end return 'done', x"), context);
+	BOOST_CHECK(co.status() == Coroutine::Status::Suspended);
+	{
+		Valset vs = co.resume(1);
+		BOOST_CHECK(vs.success());
+		BOOST_REQUIRE_EQUAL(vs.size(), 2);
+		BOOST_CHECK_EQUAL(vs[0].cast<int>(), 1);
+		BOOST_CHECK_EQUAL(vs[1].cast<string>(), "step");
+	}
+	BOOST_CHECK(co.isResumable());
+	BOOST_CHECK_EQUAL(co.resume(10).cast<int>(), 11);
+	{
+		Value v = co.resume(5);
+		BOOST_CHECK_EQUAL(v.cast<int>(), 16);
+	}
+	{
+		Valset vs = co.resume(100);
+		BOOST_CHECK(vs.success());
+		BOOST_REQUIRE_EQUAL(vs.size(), 2);
+		BOOST_CHECK_EQUAL(vs[0].cast<string>(), "done");
+		BOOST_CHECK_EQUAL(vs[1].cast<int>(), 116);
+	}
+	BOOST_CHECK(co.status() == Coroutine::Status::Finished);
+	{
+		Valset vs = co.resume();
+		BOOST_CHECK(!vs.success());
+		BOOST_CHECK_EQUAL(vs[0].cast<string>(), "cannot resume dead coroutine");
+	}
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(ResumeErrors, fxContext)
+{
+	Coroutine co(context.chunk("coroutine.yield() error('broken', 0)"), context);
+	co.resume();	// discarded result still resumes
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+	{
+		Valset vs = co.resume();
+		BOOST_CHECK(!vs.success());
+		BOOST_CHECK_EQUAL(vs[0].cast<string>(), "broken");
+	}
+	BOOST_CHECK(co.status() == Coroutine::Status::Failed);
+	BOOST_CHECK(!co.isResumable());
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(FailedConstruction, fxContext)
+{
+	context.runString("function threads() local n = 0 for _, v in pairs(debug.getregistry()) do if type(v) == 'thread' then n = n + 1 end end return n end");
+	const int before = context.global["threads"]();
+	BOOST_CHECK_THROW(Coroutine(context.chunk("syntax error"), context), std::runtime_error);
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+	context.gcCollect();
+	BOOST_CHECK_EQUAL(context.global["threads"]().cast<int>(), before);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(YieldFromLFunction, fxContext)
+{
+	context.global["yieldArg"] = lua::mkcf<lYieldArg>;
+	Coroutine co(context.chunk("local a = yieldArg(5) local b = yieldArg(a + 1) return a + b"), context);
+	BOOST_CHECK_EQUAL(co.resume().cast<int>(), 5);
+	BOOST_CHECK_EQUAL(co.resume(10).cast<int>(), 11);
+	BOOST_CHECK_EQUAL(co.resume(20).cast<int>(), 30);
+	BOOST_CHECK(co.status() == Coroutine::Status::Finished);
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+	// yielding outside of coroutine is an error
+	BOOST_CHECK_THROW(context.runString("yieldArg(1)"), std::runtime_error);
+}
+
+
+
+#if(LUAPP_API_VERSION >= 52)
+BOOST_FIXTURE_TEST_CASE(YieldWithContinuation, fxContext)
+{
+	context.global["yieldThenDouble"] = context.closure(lYieldThenDouble);
+	Coroutine co(context.chunk("local x = yieldThenDouble(3) return x + 1"), context);
+	{
+		Valset vs = co.resume();
+		BOOST_REQUIRE_EQUAL(vs.size(), 2);
+		BOOST_CHECK_EQUAL(vs[0].cast<int>(), 3);
+		BOOST_CHECK_EQUAL(vs[1].cast<string>(), "second");
+	}
+	BOOST_CHECK_EQUAL(co.resume(21).cast<int>(), 43);
+	BOOST_CHECK(co.status() == Coroutine::Status::Finished);
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+#endif	// V52+
+
+
+
+BOOST_FIXTURE_TEST_CASE(ManyCoroutines, fxContext)
+{
+	context.runString("function task(id) local sum = 0 for i = 1, 3 do sum = sum + coroutine.yield(id) end return sum end");
+	std::vector<std::unique_ptr<Coroutine>> tasks;
+	for(int i = 0; i < 1000; ++i) {
+		tasks.emplace_back(new Coroutine(context.global["task"], context));
+		BOOST_REQUIRE_EQUAL(tasks.back()->resume(i).cast<int>(), i);
+	}
+	for(int round = 1; round <= 3; ++round)
+		for(auto& t : tasks)
+			t->resume(round);
+	for(auto& t : tasks)
+		BOOST_CHECK(t->status() == Coroutine::Status::Finished);
+	tasks.clear();
+	context.gcCollect();
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(ThreadContext, fxContext)
+{
+	Coroutine co(context.chunk("shared = 'from coroutine' coroutine.yield()"), context);
+	co.resume();
+	BOOST_CHECK_EQUAL(co.context().global["shared"].cast<string>(), "from coroutine");
+	BOOST_CHECK(co.getRawThread() != context.operator lua_State*());
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+BOOST_AUTO_TEST_SUITE_END()
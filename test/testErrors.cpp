@@ -65,6 +65,51 @@ BOOST_FIXTURE_TEST_CASE(ErrorDefault, fxContext)
 	BOOST_CHECK_EQUAL(rv[0].cast<string>(), "");
 }
 
+static int destroyed = 0;
+struct DestructionMark {
+	~DestructionMark() {++destroyed;}
+};
+
+static Retval testFail(Context& c)
+{
+	DestructionMark mark;
+	Value rv("Failed ", c);
+	if(c.args.size() > 0)
+		return c.fail(rv & c.args[0]);
+	return c.ret(1);
+}
+
+static Retval testFailDefault(Context& c)
+{
+	return c.fail();
+}
+
+BOOST_FIXTURE_TEST_CASE(DeferredError, fxContext)
+{
+	destroyed = 0;
+	{
+		Valset rv = context.closure(mkcf<testFail>).pcall("softly");
+		BOOST_CHECK(!rv.success());
+		BOOST_CHECK_EQUAL(rv[0].cast<string>(), "Failed softly");
+		BOOST_CHECK_EQUAL(destroyed, 1);
+	}
+	{
+		Valset rv = context.closure(mkcf<testFail>).pcall();
+		BOOST_CHECK(rv.success());
+		BOOST_CHECK_EQUAL(rv[0].cast<int>(), 1);
+	}
+	{
+		Valset rv = context.closure(testFail).pcall("again");
+		BOOST_CHECK(!rv.success());
+		BOOST_CHECK_EQUAL(rv[0].cast<string>(), "Failed again");
+	}
+	{
+		Valset rv = context.closure(mkcf<testFailDefault>).pcall();
+		BOOST_CHECK(!rv.success());
+		BOOST_CHECK_EQUAL(rv[0].cast<string>(), "");
+	}
+}
+
 // Catching thrown errors is covered by mkcf tests in testWrappers.cpp
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,8 +1,13 @@
 #include <boost/test/unit_test.hpp>
 
 #include "fixtures.h"
+#include "luapp/lua_alloc.hpp"
+#include "luapp/lua_pool.hpp"
+#include "luapp/lua_workers.hpp"
 #include <cstring>
 #include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 using std::string;
 
@@ -56,6 +61,164 @@ BOOST_AUTO_TEST_CASE(customAllocatorCreation)
 
 
 
+static const char* const allocationWorkload =
+	"local t = {} "
+	"for i = 1, 1000 do t[i] = {tostring(i), function() return i end, string.rep('x', i)} end "
+	"for i = 1, 1000, 2 do t[i] = nil end "
+	"collectgarbage() "
+	"result = #t[1000][3]";
+
+
+
+BOOST_AUTO_TEST_CASE(selectedLibraries)
+{
+	{
+		lua::State gs(lua::lib::base | lua::lib::string | lua::lib::table | lua::lib::math);
+		gs.runString("assert(print and string and table and math)");
+		gs.runString("assert(not io and not os and not debug and not package and not require)");
+		gs.runString("assert(('x'):rep(3) == 'xxx')");	// string metatable is set
+	}
+	{
+		static_assert(!std::is_constructible<lua::State, int>::value && !std::is_constructible<lua::State, unsigned int>::value, "bare integers are not library flags");
+		lua::State gs(lua::lib::none);
+		gs.runString("x = 1");
+		BOOST_REQUIRE_THROW(gs.runString("print(x)"), std::runtime_error);
+	}
+	{
+		lua::alloc::Tracking tracking;
+		lua::State gs(&lua::alloc::Tracking::allocate, &tracking, lua::lib::base | lua::lib::package);
+		gs.runString("assert(require and package.loaded and not string)");
+	}
+	{
+		lua::State gs(lua::lib::all);
+		gs.runString("assert(print and string and table and math and io and os and debug and package)");
+	}
+}
+
+
+
+BOOST_AUTO_TEST_CASE(poolAllocator)
+{
+	lua::alloc::Pool pool;
+	lua::State gs(&lua::alloc::Pool::allocate, &pool);
+	gs.runString(allocationWorkload);
+	gs.runString("assert(result == 1000)");
+}
+
+
+
+static bool backendFailing = false;
+
+static void* failingBackend(void* ud, void* ptr, size_t oldSize, size_t newSize)
+{
+	if(backendFailing && newSize != 0)
+		return nullptr;
+	return lua::alloc::standard(ud, ptr, oldSize, newSize);
+}
+
+BOOST_AUTO_TEST_CASE(poolAllocatorShrinkNeverFails)
+{
+	typedef lua::alloc::Pool Pool;
+	Pool pool(&failingBackend);
+	std::vector<void*> blocks;
+	// fill the first chunk completely with the biggest small blocks
+	const size_t usable = Pool::chunkSize - Pool::granularity;
+	for(size_t i = 0; i < usable / Pool::maxSmallSize; ++i)
+		blocks.push_back(Pool::allocate(&pool, nullptr, 0, Pool::maxSmallSize));
+	if(usable % Pool::maxSmallSize)
+		blocks.push_back(Pool::allocate(&pool, nullptr, 0, usable % Pool::maxSmallSize));
+	void* const large = Pool::allocate(&pool, nullptr, 0, 1000);
+	BOOST_REQUIRE(large != nullptr);
+	std::memset(large, 0x5A, 1000);
+
+	backendFailing = true;
+	BOOST_CHECK(Pool::allocate(&pool, nullptr, 0, 16) == nullptr);	// growing may fail
+	void* const shrunk = Pool::allocate(&pool, blocks.front(), Pool::maxSmallSize, 16);
+	BOOST_CHECK(shrunk == blocks.front());
+	blocks.front() = shrunk;
+	void* const shrunkLarge = Pool::allocate(&pool, large, 1000, 32);
+	BOOST_REQUIRE(shrunkLarge == large);
+	BOOST_CHECK_EQUAL(static_cast<unsigned char*>(shrunkLarge)[31], 0x5A);
+	backendFailing = false;
+
+	Pool::allocate(&pool, shrunkLarge, 32, 0);
+	Pool::allocate(&pool, blocks.front(), 16, 0);
+	for(size_t i = 1; i < blocks.size(); ++i)
+		Pool::allocate(&pool, blocks[i], i + 1 < blocks.size() || usable % Pool::maxSmallSize == 0 ? Pool::maxSmallSize : usable % Pool::maxSmallSize, 0);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(arenaAllocator)
+{
+	lua::alloc::Arena arena(4096);
+	{
+		lua::State gs(&lua::alloc::Arena::allocate, &arena);
+		gs.runString(allocationWorkload);
+		gs.runString("assert(result == 1000)");
+		BOOST_CHECK_GT(arena.reserved(), 0);
+	}
+	arena.reset();
+	BOOST_CHECK_EQUAL(arena.reserved(), 0);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(limitedAllocator)
+{
+	lua::alloc::Limited limited(16 * 1024 * 1024);
+	{
+		lua::State gs(&lua::alloc::Limited::allocate, &limited);
+		BOOST_CHECK_GT(limited.used(), 0);
+		limited.setQuota(limited.used() + 16 * 1024);
+		BOOST_CHECK_THROW(gs.runString(allocationWorkload), std::runtime_error);
+		limited.setQuota(16 * 1024 * 1024);
+		gs.runString(allocationWorkload);
+		gs.runString("assert(result == 1000)");
+	}
+	BOOST_CHECK_EQUAL(limited.used(), 0);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(trackingAllocator)
+{
+	lua::alloc::Tracking tracking;
+	const lua::alloc::Stats& stats = tracking.stats();
+	{
+		lua::State gs(&lua::alloc::Tracking::allocate, &tracking);
+		lua::Context context(gs.getRawState(), lua::Context::initializeExplicitly);
+		BOOST_CHECK_GT(stats.liveBytes, 0);
+		BOOST_CHECK_EQUAL(context.queryMemoryTotal(), stats.liveBytes);
+#if(LUAPP_API_VERSION >= 52)
+		const size_t tables = stats.byType[LUA_TTABLE].count;
+		gs.runString("t = {}");
+		BOOST_CHECK_GT(stats.byType[LUA_TTABLE].count, tables);
+		const size_t strings = stats.byType[LUA_TSTRING].count, functions = stats.byType[LUA_TFUNCTION].count;
+		gs.runString("s = string.rep('long string ', 10) f = string.gmatch(s, 'l')");	// variant tags: long string, C closure
+		BOOST_CHECK_GT(stats.byType[LUA_TSTRING].count, strings);
+		BOOST_CHECK_GT(stats.byType[LUA_TFUNCTION].count, functions);
+#endif	// V52+
+		gs.runString(allocationWorkload);
+		BOOST_CHECK_GE(stats.peakBytes, stats.liveBytes);
+		size_t histogramTotal = 0, typeTotal = 0;
+		for(size_t i = 0; i < lua::alloc::Stats::histogramSize; ++i)
+			histogramTotal += stats.histogram[i];
+		for(size_t i = 0; i < lua::alloc::Stats::typeSlots; ++i)
+			typeTotal += stats.byType[i].count;
+		BOOST_CHECK_EQUAL(histogramTotal, stats.allocations + stats.reallocations);
+		BOOST_CHECK_EQUAL(typeTotal, stats.allocations);
+		BOOST_CHECK_EQUAL(stats.failures, 0);
+	}
+	BOOST_CHECK_EQUAL(stats.liveBytes, 0);
+	BOOST_CHECK_GT(stats.frees, 0);
+	tracking.reset();
+	BOOST_CHECK_EQUAL(stats.allocations, 0);
+	BOOST_CHECK_EQUAL(stats.peakBytes, 0);
+}
+
+
+
 static int fnBad(lua_State* s)
 {
 	luaL_error(s, "Error test.");
@@ -129,6 +292,195 @@ BOOST_FIXTURE_TEST_CASE(stringExecuteBad, fxState)
 
 
 
+BOOST_FIXTURE_TEST_CASE(bytecodeExecute, fxSignal)
+{
+	const string bytecode = context.dump(context.chunk("fnSignal()"));
+	gs.runBytecode(bytecode);
+	BOOST_REQUIRE(isSignaled());
+	signal = 0;
+	gs.runBytecode(bytecode.data(), bytecode.size(), "=signal");
+	BOOST_REQUIRE(isSignaled());
+	signal = 0;
+	BOOST_REQUIRE_THROW(gs.runBytecode(string("fnSignal()")), std::runtime_error);
+	BOOST_REQUIRE_THROW(gs.runBytecode(bytecode.data(), bytecode.size() / 2), std::runtime_error);
+	BOOST_REQUIRE(!isSignaled());
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(globalsSnapshot, fxState)
+{
+	BOOST_REQUIRE_THROW(gs.restoreGlobals(), std::runtime_error);
+	gs.runString("kept = 1 changed = 2 removed = 3 package.loaded.mod = {}");
+	gs.saveGlobals();
+	gs.runString("added = 4 changed = 5 removed = nil package.loaded.mod = nil package.loaded.other = {} print = nil");
+	gs.restoreGlobals();
+	gs.runString("assert(kept == 1 and changed == 2 and removed == 3 and added == nil)");
+	gs.runString("assert(package.loaded.mod and not package.loaded.other and print)");
+	gs.runString("added = 4");
+	gs.restoreGlobals();
+	gs.runString("assert(added == nil)");
+	gs.runString("setmetatable(_G, {__index = function() return 'leaked' end})"
+		" getmetatable('').__index = {len = function() return -1 end}"
+		" debug.setmetatable('', {__index = {}})"
+		" debug.sethook(function() end, 'l')");
+	gs.restoreGlobals();
+	gs.runString("assert(getmetatable(_G) == nil and undefined == nil)");
+	gs.runString("assert(('abc'):len() == 3 and getmetatable('').__index == string)");
+	gs.runString("assert(debug.gethook() == nil)");
+}
+
+
+
+BOOST_AUTO_TEST_CASE(statePool)
+{
+	size_t initialized = 0;
+	lua::StatePool pool([&](lua::State& s){
+		++initialized;
+		s.runString("counter = 0 function bump() counter = counter + 1 return counter end");
+	}, 2, 2);
+	BOOST_CHECK_EQUAL(initialized, 2);
+	BOOST_CHECK_EQUAL(pool.idleCount(), 2);
+	{
+		lua::StatePool::Lease l1 = pool.acquire();
+		lua::StatePool::Lease l2 = pool.acquire();
+		lua::StatePool::Lease l3 = pool.acquire();
+		BOOST_CHECK_EQUAL(initialized, 3);
+		BOOST_CHECK_EQUAL(pool.idleCount(), 0);
+		l1->runString("assert(bump() == 1) leaked = true");
+		l2.drop();
+		BOOST_CHECK(!l2);
+	}
+	BOOST_CHECK_EQUAL(pool.idleCount(), 2);
+	for(int i = 0; i < 2; ++i) {
+		lua::StatePool::Lease l = pool.acquire();
+		lua::Context context(l->getRawState(), lua::Context::initializeExplicitly);
+		BOOST_CHECK(context.global["leaked"].is<lua::Nil>());
+		BOOST_CHECK_EQUAL(context.global["bump"]().cast<int>(), 1);
+		l.release();
+		BOOST_CHECK(!l);
+	}
+	BOOST_CHECK_EQUAL(initialized, 3);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(statePoolMemoryLimit)
+{
+	lua::StatePool pool(lua::StatePool::Initializer(), 1, 4, 256 * 1024);
+	{
+		lua::StatePool::Lease l = pool.acquire();
+		l->runString("big = string.rep('x', 1024 * 1024)");
+	}
+	BOOST_CHECK_EQUAL(pool.idleCount(), 1);	// the global was dropped, so the string was collected
+	{
+		lua::StatePool::Lease l = pool.acquire();
+		l->runString("local t = {} for i = 1, 20000 do t[i] = {} end string.cache = t");	// library tables are not restored
+	}
+	BOOST_CHECK_EQUAL(pool.idleCount(), 0);
+}
+
+
+
+
+BOOST_AUTO_TEST_CASE(plainValues)
+{
+	lua::State gs;
+	lua_State* L = gs.getRawState();
+	const lua::PlainValue src[] = {lua::nil, true, 42, 2.5, "text", string("with\0zero", 9)};
+	for(const auto& v : src)
+		v.push(L);
+	BOOST_CHECK(lua::PlainValue::read(L, 1).type() == lua::ValueType::Nil);
+	BOOST_CHECK_EQUAL(lua::PlainValue::read(L, 2).cast<bool>(), true);
+	BOOST_CHECK_EQUAL(lua::PlainValue::read(L, 3).cast<int>(), 42);
+	BOOST_CHECK_EQUAL(lua::PlainValue::read(L, 4).cast<double>(), 2.5);
+	BOOST_CHECK_EQUAL(lua::PlainValue::read(L, 5).cast<string>(), "text");
+	BOOST_CHECK_EQUAL(lua::PlainValue::read(L, 6).cast<string>().size(), 9);
+#if(LUAPP_API_VERSION >= 53)
+	BOOST_CHECK(lua::PlainValue::read(L, 3).isInteger());
+	BOOST_CHECK(!lua::PlainValue::read(L, 4).isInteger());
+#endif
+	BOOST_CHECK_THROW(lua::PlainValue::read(L, 5).cast<int>(), std::runtime_error);
+	lua_newtable(L);
+	BOOST_CHECK_THROW(lua::PlainValue::read(L, -1), std::runtime_error);
+	lua_settop(L, 0);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(workers)
+{
+	lua::Workers workers(3, [](lua::State& s){
+		s.runString("calls = 0 function add(a, b) calls = calls + 1 return a + b, calls end");
+		s.runString("function echo(...) return ... end function fail() error('failure', 0) end function tbl() return {} end");
+	});
+	BOOST_CHECK_EQUAL(workers.size(), 3);
+
+	std::vector<std::future<lua::Workers::Values>> replies;
+	for(int i = 0; i < 300; ++i)
+		replies.push_back(workers.call("add", i, 1));
+	for(int i = 0; i < 300; ++i) {
+		const lua::Workers::Values rv = replies[i].get();
+		BOOST_REQUIRE_EQUAL(rv.size(), 2);
+		BOOST_CHECK_EQUAL(rv[0].cast<int>(), i + 1);
+	}
+
+	// calls submitted to one worker are executed in order by its own state
+	std::future<lua::Workers::Values> first = workers.submit(1, "add", {0, 0});
+	std::future<lua::Workers::Values> second = workers.submit(1, "add", {0, 0});
+	BOOST_CHECK_EQUAL(second.get()[1].cast<int>(), first.get()[1].cast<int>() + 1);
+
+	const lua::Workers::Values echo = workers.call("echo", lua::nil, false, "str", 0.5).get();
+	BOOST_REQUIRE_EQUAL(echo.size(), 4);
+	BOOST_CHECK(echo[0].type() == lua::ValueType::Nil);
+	BOOST_CHECK_EQUAL(echo[1].cast<bool>(), false);
+	BOOST_CHECK_EQUAL(echo[2].cast<string>(), "str");
+	BOOST_CHECK_EQUAL(echo[3].cast<double>(), 0.5);
+
+	std::future<lua::Workers::Values> failure = workers.call("fail");
+	try {
+		failure.get();
+		BOOST_ERROR("Error was not reported");
+	} catch(std::runtime_error& e) {
+		BOOST_CHECK_EQUAL(e.what(), string("failure"));
+	}
+	BOOST_CHECK_THROW(workers.call("tbl").get(), std::runtime_error);
+	BOOST_CHECK_THROW(workers.call("missing").get(), std::runtime_error);
+	BOOST_CHECK_EQUAL(workers.call("add", 2, 3).get()[0].cast<int>(), 5);	// workers survive errors
+}
+
+
+
+BOOST_AUTO_TEST_CASE(workersStrictGlobals)
+{
+	// lookup of unknown function raises an error from "__index" of _G (as strict.lua does)
+	lua::Workers workers(1, [](lua::State& s){
+		s.runString("function id(x) return x end setmetatable(_G, {__index = function(_, k) error('undeclared ' .. k, 0) end})");
+	});
+	try {
+		workers.call("missing").get();
+		BOOST_ERROR("Error was not reported");
+	} catch(std::runtime_error& e) {
+		BOOST_CHECK_EQUAL(e.what(), string("undeclared missing"));
+	}
+	BOOST_CHECK_EQUAL(workers.call("id", 7).get().at(0).cast<int>(), 7);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(workersShutdown)
+{
+	std::vector<std::future<lua::Workers::Values>> replies;
+	{
+		lua::Workers workers(2, [](lua::State& s){ s.runString("function spin(n) local x = 0 for i = 1, n do x = x + i end return x end"); });
+		for(int i = 0; i < 50; ++i)
+			replies.push_back(workers.call("spin", 10000));
+	}	// destructor completes queued calls
+	for(auto& r : replies)
+		BOOST_CHECK_EQUAL(r.get().at(0).cast<long long>(), 50005000LL);
+	BOOST_CHECK_THROW(lua::Workers(1, [](lua::State& s){ s.runString("error('init')"); }), std::runtime_error);
+}
+
 #ifdef LUAPP_SAFE_EXCEPTIONS
 static void fnNestedError()
 {
@@ -1,7 +1,13 @@
 #include <boost/test/unit_test.hpp>
 
 #include "fixtures.h"
+#include <list>
+#include <iterator>
+#include <map>
+#include <sstream>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 using lua::Valref;
 using lua::Value;
@@ -207,4 +213,203 @@ BOOST_FIXTURE_TEST_CASE(RawAccess, fxContext)
 
 
 
+
+BOOST_FIXTURE_TEST_CASE(RangeFill, fxContext)
+{
+	{
+		std::vector<double> numbers;
+		for(int i = 0; i < 1000; ++i)
+			numbers.push_back(i + 0.5);
+		Table t = Table::fromRange(context, numbers);
+		BOOST_CHECK_EQUAL(t[1].cast<double>(), 0.5);
+		BOOST_CHECK_EQUAL(t[1000].cast<double>(), 999.5);
+		BOOST_CHECK(t[1001].type() == lua::ValueType::Nil);
+		BOOST_CHECK_EQUAL(context.getTop(), 1);
+	}
+	{
+		const int integers[] = {3, 2, 1};
+		Table t = Table::fromRange(context, integers);
+		BOOST_CHECK_EQUAL(t[1].cast<int>(), 3);
+		BOOST_CHECK_EQUAL(t[3].cast<int>(), 1);
+	}
+	{
+		const std::list<string> strings = {"one", string("t\0o", 3), "three"};
+		Table t = Table::fromRange(context, strings);
+		BOOST_CHECK_EQUAL(t[2].cast<string>(), string("t\0o", 3));
+		BOOST_CHECK_EQUAL(t[3].cast<string>(), "three");
+		const char* const literals[] = {"a", "b"};
+		t.assign(std::begin(literals), std::end(literals));
+		BOOST_CHECK_EQUAL(t[1].cast<string>(), "a");
+		BOOST_CHECK_EQUAL(t[2].cast<string>(), "b");
+		BOOST_CHECK(t[3].type() == lua::ValueType::Nil);
+	}
+	{
+		// input iterator reuses the same string for every element
+		std::istringstream words("alpha beta gamma");
+		Table t(context);
+		t.assign(std::istream_iterator<string>(words), std::istream_iterator<string>());
+		BOOST_CHECK_EQUAL(t[1].cast<string>(), "alpha");
+		BOOST_CHECK_EQUAL(t[2].cast<string>(), "beta");
+		BOOST_CHECK_EQUAL(t[3].cast<string>(), "gamma");
+		BOOST_CHECK(t[4].type() == lua::ValueType::Nil);
+	}
+	{
+		context.registerUserData<Udata>();
+		const std::vector<Udata> uds = {{1}, {2}};
+		Table t = Table::fromRange(context, uds);
+		BOOST_CHECK_EQUAL(t[1].cast<Udata>().x, 1);
+		BOOST_CHECK_EQUAL(t[2].cast<Udata>().x, 2);
+	}
+	{
+		const std::vector<bool> flags = {true, false};
+		Table t(context);
+		t.raw[5] = 5;
+		t.assign(flags.begin(), flags.end());
+		BOOST_CHECK_EQUAL(t[1].cast<bool>(), true);
+		BOOST_CHECK_EQUAL(t[2].cast<bool>(), false);
+		BOOST_CHECK_EQUAL(t[5].cast<int>(), 5);	// not a part of the sequence
+	}
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+
+BOOST_FIXTURE_TEST_CASE(Extraction, fxContext)
+{
+	context.runString("arr = {} for i = 1, 1000 do arr[i] = i end names = {'a', 'b', 'c'} mixed = {1, 'x', 3, {}, 5}");
+	{
+		Table t = context.global["arr"];
+		const std::vector<int> v = t.toVector<int>();
+		BOOST_REQUIRE_EQUAL(v.size(), 1000);
+		BOOST_CHECK_EQUAL(v.front(), 1);
+		BOOST_CHECK_EQUAL(v.back(), 1000);
+		std::list<double> l;
+		t.copyTo<double>(std::back_inserter(l));
+		BOOST_CHECK_EQUAL(l.size(), 1000);
+		BOOST_CHECK_EQUAL(l.back(), 1000.0);
+	}
+	{
+		Table t = context.global["names"];
+		const std::vector<string> v = t.toVector<string>();
+		BOOST_REQUIRE_EQUAL(v.size(), 3);
+		BOOST_CHECK_EQUAL(v[1], "b");
+	}
+	{
+		Table t = context.global["mixed"];
+		std::vector<int> v;
+		BOOST_CHECK_THROW(t.copyTo<int>(std::back_inserter(v)), std::runtime_error);
+		BOOST_CHECK_EQUAL(v.size(), 3);	// convertible elements are copied anyway
+		BOOST_CHECK_EQUAL(v[2], 5);
+		BOOST_CHECK_EQUAL(context.getTop(), 1);
+	}
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(MapExtraction, fxContext)
+{
+	context.runString("rec = {one = 1, two = 2, three = 3} bad = {one = 1, [2] = 2, three = 'x'}");
+	{
+		Table t = context.global["rec"];
+		const std::map<string, int> m = t.toMap<std::map<string, int>>();
+		BOOST_REQUIRE_EQUAL(m.size(), 3);
+		BOOST_CHECK_EQUAL(m.at("two"), 2);
+		const std::unordered_map<string, double> um = t.toMap<std::unordered_map<string, double>>();
+		BOOST_CHECK_EQUAL(um.at("three"), 3.0);
+	}
+	{
+		Table t = context.global["bad"];
+		BOOST_CHECK_THROW((t.toMap<std::map<string, int>>()), std::runtime_error);
+		BOOST_CHECK_EQUAL(context.getTop(), 1);
+	}
+	{
+		Table t = Table::records(context, 10, "a", 20, 5);
+		const std::map<int, string> m = t.toMap<std::map<int, string>>();	// numbers are converted to strings
+		BOOST_REQUIRE_EQUAL(m.size(), 2);
+		BOOST_CHECK_EQUAL(m.at(20), "5");
+	}
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+
+BOOST_FIXTURE_TEST_CASE(RangeIteration, fxContext)
+{
+	context.runString("val = {10, 20, 30, x = 'a'}");
+	Table t = context.global["val"];
+	{
+		int count = 0;
+		for(auto e : t.pairs()) {
+			++count;
+			if(e.key.type() == lua::ValueType::String)
+				BOOST_CHECK_EQUAL(e.value.cast<string>(), "a");
+			else
+				BOOST_CHECK_EQUAL(e.key.cast<int>() * 10, e.value.cast<int>());
+		}
+		BOOST_CHECK_EQUAL(count, 4);
+		BOOST_CHECK_EQUAL(context.getTop(), 1);
+	}
+	{
+		int count = 0;
+		for(auto e : t.pairs()) {
+			static_cast<void>(e);
+			if(++count == 2)
+				break;
+		}
+		BOOST_CHECK_EQUAL(count, 2);
+		BOOST_CHECK_EQUAL(context.getTop(), 1);
+	}
+	{
+		auto range = t.pairs();
+		Value extra(5, context);	// stack grows before the traversal starts
+		int sum = 0;
+		for(auto e : range)
+			if(e.key.type() == lua::ValueType::Number)
+				sum += e.value.cast<int>();
+		BOOST_CHECK_EQUAL(sum, 60);
+		BOOST_CHECK_EQUAL(extra.cast<int>(), 5);
+	}
+	BOOST_CHECK_EQUAL(context.getTop(), 1);
+	{
+		size_t sum = 0, last = 0;
+		for(auto e : t.ipairs()) {
+			BOOST_CHECK_EQUAL(e.index, last + 1);
+			last = e.index;
+			sum += e.value.cast<unsigned int>();
+		}
+		BOOST_CHECK_EQUAL(last, 3);
+		BOOST_CHECK_EQUAL(sum, 60);
+		BOOST_CHECK_EQUAL(context.getTop(), 1);
+	}
+	{
+		for(auto e : t.ipairs())
+			if(e.index == 2)
+				break;
+		BOOST_CHECK_EQUAL(context.getTop(), 1);
+	}
+#ifdef __cpp_structured_bindings
+	{
+		int sum = 0;
+		for(auto [k, v] : t.pairs())
+			if(k.type() == lua::ValueType::Number)
+				sum += v.cast<int>();
+		BOOST_CHECK_EQUAL(sum, 60);
+		for(auto [i, v] : t.ipairs())
+			sum -= static_cast<int>(i) * 10 - v.cast<int>() + 20;
+		BOOST_CHECK_EQUAL(sum, 0);
+	}
+#endif	// __cpp_structured_bindings
+	Table empty(context);
+	for(auto e : empty.ipairs())
+		BOOST_CHECK(e.value.type() == lua::ValueType::Nil);
+	for(auto e : empty.pairs())
+		BOOST_CHECK(e.key.type() == lua::ValueType::Nil);
+	BOOST_CHECK_EQUAL(context.getTop(), 2);
+}
+
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,7 @@
 #include "fixtures.h"
 #include <cstring>
 #include <stdexcept>
+#include <string>
 
 
 struct Udata{int x;};
@@ -10,6 +11,22 @@ LUAPP_USERDATA(Udata, "Test.Userdata")
 struct Otherdata{int x;};
 LUAPP_USERDATA(Otherdata, "Test.Otherdata")
 
+static int destroyed = 0;
+struct Tracked{
+	int x;
+	~Tracked() {++destroyed;}
+};
+LUAPP_USERDATA(Tracked, "Test.Tracked")
+
+struct Pinned{
+	Pinned(int x_, std::string&& s_): x(x_), s(std::move(s_)) {}
+	Pinned(const Pinned&) = delete;
+	Pinned(Pinned&&) = delete;
+	int x;
+	std::string s;
+};
+LUAPP_USERDATA(Pinned, "Test.Pinned")
+
 
 
 
@@ -58,4 +75,117 @@ BOOST_FIXTURE_TEST_CASE(Transfer, fxud)
 
 
 
+BOOST_FIXTURE_TEST_CASE(RepeatedTypeControl, fxud)
+{
+	context.global["val"] = Udata{42};
+	context.global["other"] = Otherdata{24};
+	for(int i = 0; i < 3; ++i) {
+		BOOST_CHECK(context.global["val"].is<Udata>());
+		BOOST_CHECK(!context.global["val"].is<Otherdata>());
+		BOOST_CHECK(context.global["other"].is<Otherdata>());
+		BOOST_CHECK(!context.global["other"].is<Udata>());
+		BOOST_CHECK(!context.global["nosuchval"].is<Udata>());
+		BOOST_CHECK(!context.global["light"].is<Udata>());
+	}
+	context.global["light"] = static_cast<lua::LightUserData>(&context);
+	BOOST_CHECK(!context.global["light"].is<Udata>());
+	BOOST_CHECK_THROW(context.global["other"].cast<Udata>(), std::runtime_error);
+
+	context.mt<Udata>() = lua::Table::records(context);
+	context.global["newval"] = Udata{43};
+	BOOST_CHECK(context.global["newval"].is<Udata>());
+	BOOST_CHECK_EQUAL(context.global["newval"].cast<Udata>().x, 43);
+	BOOST_CHECK(!context.global["newval"].is<Otherdata>());
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(ReplacedMetatable, fxud)
+{
+	context.global["old"] = Udata{1};
+	BOOST_CHECK(context.global["old"].is<Udata>());	// remembered here
+	context.mt<Udata>() = lua::Table::records(context);
+	BOOST_CHECK(!context.global["old"].is<Udata>());
+	BOOST_CHECK_THROW(context.global["old"].cast<Udata>(), std::runtime_error);
+	context.global["new"] = Udata{2};
+	BOOST_CHECK(context.global["new"].is<Udata>());
+	BOOST_CHECK(!context.global["old"].is<Udata>());
+
+	context.registerUserData<Udata>();
+	BOOST_CHECK(!context.global["new"].is<Udata>());
+
+	context.global["newest"] = Udata{3};
+	BOOST_CHECK(context.global["newest"].is<Udata>());
+	BOOST_CHECK(context.mt<Udata>().type() == lua::ValueType::Table);	// reading keeps remembered metatable valid
+	BOOST_CHECK(context.global["newest"].is<Udata>());
+	context.registry[lua::UserData<Udata>::classname] = lua::Table::records(context);
+	BOOST_CHECK(!context.global["newest"].is<Udata>());
+	context.global["latest"] = Udata{4};
+	BOOST_CHECK(context.global["latest"].is<Udata>());
+	context.mt<Udata>() = lua::nil;
+	BOOST_CHECK(!context.global["latest"].is<Udata>());
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(AutomaticFinalizer, fxContext)
+{
+	context.registerUserData<Tracked>()["marker"] = 5;
+	BOOST_CHECK(context.mt<Tracked>()["__gc"].is<lua::CFunction>());
+	BOOST_CHECK_EQUAL(context.mt<Tracked>()["marker"].cast<int>(), 5);
+	context.global["val"] = Tracked{42};
+	destroyed = 0;	// the source temporary is gone by now
+	BOOST_CHECK(context.global["val"].is<Tracked>());
+	BOOST_CHECK_EQUAL(context.global["val"].cast<Tracked>().x, 42);
+	context.global["val"] = lua::nil;
+	context.gcCollect();
+	BOOST_CHECK_EQUAL(destroyed, 1);
+
+	lua::Table mt = context.registerUserData<Udata>();
+	BOOST_CHECK(mt["__gc"].is<lua::Nil>());
+	context.global["val"] = Udata{42};
+	BOOST_CHECK(context.global["val"].is<Udata>());
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(FinalizerMisuse, fxContext)
+{
+	context.registerUserData<Tracked>();
+	context.registerUserData<Pinned>();
+	context.global["val"] = Tracked{1};
+	context.global["pinned"] = context.emplace<Pinned>(2, std::string("pinned"));
+	destroyed = 0;
+	context.runString("local gc = getmetatable(val).__gc gc(pinned) gc(42) gc(val) gc(val)");
+	BOOST_CHECK_EQUAL(destroyed, 1);
+	BOOST_CHECK(!context.global["val"].is<Tracked>());
+	lua::Value pinned = context.global["pinned"];
+	BOOST_CHECK(pinned.is<Pinned>());
+	BOOST_CHECK_EQUAL(pinned.cast<Pinned>().s, "pinned");
+	context.global["val"] = lua::nil;
+	context.gcCollect();
+	BOOST_CHECK_EQUAL(destroyed, 1);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(Emplace, fxContext)
+{
+	context.registerUserData<Pinned>();
+	context.global["val"] = context.emplace<Pinned>(42, std::string("pinned"));
+	lua::Value p = context.global["val"];
+	BOOST_CHECK(p.is<Pinned>());
+	BOOST_CHECK_EQUAL(p.cast<Pinned>().x, 42);
+	BOOST_CHECK_EQUAL(p.cast<Pinned>().s, "pinned");
+
+	context.mt<Udata>() = lua::Table::records(context);
+	lua::Value v = context.emplace<Udata>();
+	BOOST_CHECK(v.is<Udata>());
+	BOOST_CHECK_EQUAL(v.cast<Udata>().x, 0);
+	lua::Value agg = context.emplace<Udata>(7);
+	BOOST_CHECK_EQUAL(agg.cast<Udata>().x, 7);
+}
+
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -414,6 +414,51 @@ BOOST_FIXTURE_TEST_CASE(String, fxGlobalVal)
 
 
 
+BOOST_FIXTURE_TEST_CASE(BinaryString, fxGlobalVal)
+{
+	const string src("binary\0string", 13);
+	v = src;
+	BOOST_CHECK(v.is<lua::StringRef>());
+	BOOST_CHECK_EQUAL(v.cast<string>(), src);
+	BOOST_CHECK_EQUAL(v.to<string>(), src);
+	{
+		const string converted = v;
+		BOOST_CHECK_EQUAL(converted, src);
+	}
+	{
+		const lua::StringRef converted = v.cast<lua::StringRef>();
+		BOOST_CHECK_EQUAL(converted.size, src.size());
+		BOOST_CHECK(string(converted.data, converted.size) == src);
+		BOOST_CHECK(converted.data == v.cast<const char*>());
+	}
+
+	v = lua::StringRef{src.data(), 8};
+	BOOST_CHECK_EQUAL(v.cast<string>(), string("binary\0s", 8));
+
+	l = src;
+	BOOST_CHECK_EQUAL(l.cast<string>(), src);
+	BOOST_CHECK_EQUAL(l.cast<lua::StringRef>().size, src.size());
+
+	v = 3.14;
+	BOOST_CHECK_EQUAL(v.cast<lua::StringRef>().size, 4);
+	v = nil;
+	BOOST_CHECK(!v.is<lua::StringRef>());
+	BOOST_CHECK_THROW(v.cast<lua::StringRef>(), std::runtime_error);
+	BOOST_CHECK_EQUAL(v.to<string>(), string());
+
+#ifdef LUAPP_STRING_VIEW
+	v = std::string_view(src);
+	BOOST_CHECK(v.is<std::string_view>());
+	BOOST_CHECK(v.cast<std::string_view>() == src);
+	BOOST_CHECK(v.to<std::string_view>() == src);
+	v = nil;
+	BOOST_CHECK_THROW(v.cast<std::string_view>(), std::runtime_error);
+	BOOST_CHECK(v.to<std::string_view>().empty());
+#endif	// LUAPP_STRING_VIEW
+}
+
+
+
 BOOST_FIXTURE_TEST_CASE(NumberStringConversion, fxGlobalVal)
 {
 	const double nsrc = 3.14;
@@ -227,6 +227,43 @@ BOOST_FIXTURE_TEST_CASE(ReturningReferences, fxContext)
 
 
 
+static const char* lastStringData = nullptr;
+
+static int strrefwrapped(lua::StringRef x)
+{
+	lastStringData = x.data;
+	return static_cast<int>(x.size);
+}
+
+#ifdef LUAPP_STRING_VIEW
+static std::string_view viewwrapped(std::string_view x)
+{
+	lastStringData = x.data();
+	return x.substr(1);
+}
+#endif	// LUAPP_STRING_VIEW
+
+BOOST_FIXTURE_TEST_CASE(StringViewArguments, fxContext)
+{
+	const string src("view\0test", 9);
+	Value str(src, context);
+	context.global["fn"] = context.wrap(strrefwrapped);
+	BOOST_CHECK_EQUAL(context.global["fn"](str).cast<int>(), 9);
+	BOOST_CHECK(lastStringData == str.cast<const char*>());
+	{
+		Valset vs = context.global["fn"].pcall(Table::records(context));
+		BOOST_CHECK(!vs.success());
+	}
+
+#ifdef LUAPP_STRING_VIEW
+	context.global["fn"] = context.wrap(viewwrapped);
+	BOOST_CHECK_EQUAL(context.global["fn"](str).cast<string>(), src.substr(1));
+	BOOST_CHECK(lastStringData == str.cast<const char*>());
+#endif	// LUAPP_STRING_VIEW
+}
+
+
+
 BOOST_FIXTURE_TEST_CASE(TransparentWrapping, fxContext)
 {
 	context.global["fn"] = wrapped1;
@@ -336,4 +373,171 @@ BOOST_FIXTURE_TEST_CASE(ComplicatedMemberWrapping, fxContext)
 
 
 
+BOOST_FIXTURE_TEST_CASE(StaticWrappers, fxContext)
+{
+	signal = 0;
+	context.mt<Udata>() = Table::records(context);
+	context.mt<SimpleClass>() = Table::records(context);
+	context.global["fn"] = lua::wrapcf<decltype(&wrapped1), &wrapped1>;
+	BOOST_CHECK(context.global["fn"].is<lua::CFunction>());
+	BOOST_CHECK_EQUAL(context.global["fn"](3).cast<int>(), 9);
+	{
+		Valset vs = context.global["fn"].pcall();
+		BOOST_CHECK(!vs.success());
+	}
+
+	context.global["fn"] = lua::wrapcf<decltype(&wrapped0nc), &wrapped0nc>;
+	context.global["fn"](Udata{3});
+	BOOST_CHECK_EQUAL(signal, 4);
+
+	context.global["fn"] = lua::wrapcf<decltype(&failWrapped), &failWrapped>;
+	{
+		Valset vs = context.global["fn"].pcall();
+		BOOST_CHECK(!vs.success());
+		BOOST_CHECK(vs[0].cast<string>().find("Wrapped fail") != string::npos);
+	}
+
+	Value u(SimpleClass{3}, context);
+	context.global["fn"] = lua::wrapcf<decltype(&SimpleClass::increment), &SimpleClass::increment>;
+	BOOST_CHECK_EQUAL(context.global["fn"](u).cast<int>(), 4);
+	context.global["fn"] = lua::wrapcf<decltype(&SimpleClass::decrement), &SimpleClass::decrement>;
+	BOOST_CHECK_EQUAL(context.global["fn"](u).cast<int>(), 3);
+	context.global["fn"] = lua::wrapcf<decltype(&SimpleClass::write), &SimpleClass::write>;
+	context.global["fn"](u, 12);
+	context.global["fn"] = lua::wrapcf<decltype(&SimpleClass::read), &SimpleClass::read>;
+	BOOST_CHECK_EQUAL(context.global["fn"](u).cast<int>(), 12);
+
+#ifdef LUAPP_NONTYPE_AUTO
+	context.global["fn"] = lua::wrapStatic<&wrapped1>;
+	BOOST_CHECK_EQUAL(context.global["fn"](5).cast<int>(), 15);
+	context.global["fn"] = lua::wrapStatic<&SimpleClass::read>;
+	BOOST_CHECK_EQUAL(context.global["fn"](u).cast<int>(), 12);
+#endif	// LUAPP_NONTYPE_AUTO
+}
+
+
+
+static double fastAdd(double x, int y)
+{
+	return x + y;
+}
+
+static int flagged(bool flag, int x)
+{
+	return flag ? x : -x;
+}
+
+BOOST_FIXTURE_TEST_CASE(FastWrappers, fxContext)
+{
+	signal = 0;
+	context.global["fn"] = context.fastwrap(fastAdd);
+	BOOST_CHECK_EQUAL(context.global["fn"](1.5, 2).cast<double>(), 3.5);
+	{
+		Valset vs = context.global["fn"].pcall(1.5, "x");
+		BOOST_REQUIRE(!vs.success());
+		BOOST_CHECK(vs[0].cast<string>().find("Argument 2") != string::npos);
+	}
+	{
+		Valset vs = context.global["fn"].pcall(1.5);
+		BOOST_REQUIRE(!vs.success());
+		BOOST_CHECK(vs[0].cast<string>().find("Insufficient number of arguments") != string::npos);
+	}
+
+	context.global["fn"] = context.fastwrap(swrapped0);
+	context.global["fn"](7);
+	BOOST_CHECK_EQUAL(signal, 7);
+
+	context.mt<SimpleClass>() = Table::records(context);
+	Value u(SimpleClass{3}, context);
+	context.global["fn"] = context.fastwrap(&SimpleClass::increment);
+	BOOST_CHECK_EQUAL(context.global["fn"](u).cast<int>(), 4);
+	context.global["fn"] = context.fastwrap(&SimpleClass::write);
+	context.global["fn"](u, 12);
+	context.global["fn"] = context.fastwrap(&SimpleClass::read);
+	BOOST_CHECK_EQUAL(context.global["fn"](u).cast<int>(), 12);
+	{
+		Valset vs = context.global["fn"].pcall(1);
+		BOOST_REQUIRE(!vs.success());
+		BOOST_CHECK(vs[0].cast<string>().find("Argument 1") != string::npos);
+	}
+
+	context.global["fn"] = lua::fastwrapcf<decltype(&fastAdd), &fastAdd>;
+	BOOST_CHECK_EQUAL(context.global["fn"](0.5, 1).cast<double>(), 1.5);
+	{
+		Valset vs = context.global["fn"].pcall(lua::nil, 1);
+		BOOST_CHECK(!vs.success());
+	}
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(FastWrappedBool, fxContext)
+{
+	// bool accepts any value in both kinds of wrappers
+	context.global["slow"] = context.wrap(flagged);
+	context.global["fast"] = context.fastwrap(flagged);
+	for(const char* name : {"slow", "fast"}) {
+		BOOST_CHECK_EQUAL(context.global[name](true, 2).cast<int>(), 2);
+		BOOST_CHECK_EQUAL(context.global[name](false, 2).cast<int>(), -2);
+		BOOST_CHECK_EQUAL(context.global[name](lua::nil, 3).cast<int>(), -3);
+		BOOST_CHECK_EQUAL(context.global[name](0, 4).cast<int>(), 4);
+		BOOST_CHECK_EQUAL(context.global[name](1.5, 5).cast<int>(), 5);
+	}
+	{
+		Valset vs = context.global["fast"].pcall(true, "x");
+		BOOST_REQUIRE(!vs.success());
+		BOOST_CHECK(vs[0].cast<string>().find("Argument 2") != string::npos);
+	}
+	BOOST_CHECK_EQUAL(context.getTop(), 0);
+}
+
+
+
+struct CountedFunctor{
+	explicit CountedFunctor(int& counter_): counter(&counter_) {}
+	CountedFunctor(CountedFunctor&& src): counter(src.counter) {src.counter = nullptr;}
+	~CountedFunctor() {if(counter) ++*counter;}
+	int operator()(int x) const {return x * 2;}
+	int* counter;
+};
+
+
+
+BOOST_FIXTURE_TEST_CASE(FunctorWrapping, fxContext)
+{
+	int total = 0;
+	context.global["fn"] = context.wrap([&total](int x) {total += x; return total;});
+	context.global["fn"](3);
+	const int result = context.global["fn"](4);
+	BOOST_CHECK_EQUAL(result, 7);
+	BOOST_CHECK_EQUAL(total, 7);
+
+	int counter = 10;
+	context.global["fn"] = context.wrap([counter](int x) mutable {counter += x;});
+	context.global["fn"](5);
+	BOOST_CHECK_EQUAL(counter, 10);
+
+	context.global["fn"] = context.wrap([&total](int x) noexcept {return total - x;});
+	BOOST_CHECK_EQUAL(context.global["fn"](2).cast<int>(), 5);
+	context.global["fn"] = context.wrap([counter](int x) mutable noexcept {return counter += x;});
+	context.global["fn"](5);
+	BOOST_CHECK_EQUAL(context.global["fn"](5).cast<int>(), 20);
+
+	context.global["fn"] = context.wrap([&total](Context& c) {return c.ret(static_cast<int>(c.args.size()), total);});
+	Valset vs = context.global["fn"](1, 2, 3);
+	BOOST_REQUIRE_EQUAL(vs.size(), 2u);
+	BOOST_CHECK_EQUAL(vs[0].cast<int>(), 3);
+	BOOST_CHECK_EQUAL(vs[1].cast<int>(), 7);
+
+	int destroyed = 0;
+	context.global["fn"] = context.wrap(CountedFunctor(destroyed));
+	BOOST_CHECK_EQUAL(destroyed, 0);
+	BOOST_CHECK_EQUAL(context.global["fn"](21).cast<int>(), 42);
+	context.global["fn"] = lua::nil;
+	context.gcCollect();
+	BOOST_CHECK_EQUAL(destroyed, 1);
+}
+
+
+
 BOOST_AUTO_TEST_SUITE_END()